@@ -1,6 +1,9 @@
 /*
 2026-02-06
 버튼으로 led제어하기
+2026-10-16 10ms 폴링 대신 양방향 에지 이벤트로 대기
+           마지막 에지 뒤로 10ms 동안 값이 그대로일 때만 안정된 값으로 보고 LED에 반영
+           (다음 에지의 타임스탬프나 10ms 대기 시간 초과로 판단하므로 마지막 전이도 빠지지 않음)
 */
 
 #include <stdio.h>
@@ -8,6 +11,10 @@
 #include <unistd.h>
 #include <gpiod.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+#define DEBOUNCE_NS 10000000LL   // 이만큼 바뀌지 않아야 안정된 값 (10ms)
+#define EVENT_BATCH 16           // 한 번에 읽는 최대 이벤트 수
 
 int main(void)
 {
@@ -18,7 +25,14 @@ int main(void)
     struct gpiod_chip *chip;
     struct gpiod_line *led_line;    // LED용 변수 따로
     struct gpiod_line *button_line; // 버튼용 변수 따로
-    int val;
+    int val;                      // LED에 반영한 안정된 값
+    int raw_val = 0;              // 마지막 에지 후 값
+    bool pending = false;         // 안정 판정을 기다리는 에지가 있음
+    struct gpiod_line_event events[EVENT_BATCH];
+    struct timespec settle = { 0, DEBOUNCE_NS };
+    int64_t last_ns = 0;          // 마지막 에지 시각
+    int64_t ts_ns;
+    int count, ret;
 
     // 1. 칩 열기
     chip = gpiod_chip_open_by_name(chipname);
@@ -31,22 +45,53 @@ int main(void)
     led_line = gpiod_chip_get_line(chip, led_pin);
     gpiod_line_request_output(led_line, "led-out", 0);
 
-    // 3. 버튼 핀 설정 (입력)
+    // 3. 버튼 핀 설정 (양방향 에지 이벤트 입력)
     button_line = gpiod_chip_get_line(chip, button_pin);
-    gpiod_line_request_input(button_line, "button-in");
+    if (gpiod_line_request_both_edges_events(button_line, "button-in") < 0) {
+        perror("button event request error");
+        exit(1);
+    }
 
     printf("test start\n");
 
-    // 4. 무한 루프
+    // 시작할 때의 버튼 상태를 LED에 반영
+    // *연결 방식에 따라 반대(눌리면 0)일 수 있음
+    val = gpiod_line_get_value(button_line);
+    gpiod_line_set_value(led_line, val);
+
+    // 4. 무한 루프 (에지가 올 때, 또는 기다리는 에지가 있으면 10ms 뒤에 깨어남)
     while (true) {
-        // 버튼 상태 읽기 (눌리면 1, 아니면 0)
-        // *연결 방식에 따라 반대(눌리면 0)일 수 있음
-        val = gpiod_line_get_value(button_line);
-        
-        // 읽은 값을 LED에 그대로 전달
-        gpiod_line_set_value(led_line, val);
-
-        usleep(10000); // 0.01초 대기 (CPU 부하 감소)
+        ret = gpiod_line_event_wait(button_line, pending ? &settle : NULL);
+        if (ret < 0) {
+            perror("event wait error");
+            break;
+        }
+
+        // 마지막 에지 뒤로 10ms 동안 에지가 없었으면 그 값이 안정된 값
+        if (ret == 0) {
+            pending = false;
+            if (raw_val != val) {
+                val = raw_val;
+                gpiod_line_set_value(led_line, val);
+            }
+            continue;
+        }
+
+        count = gpiod_line_event_read_multiple(button_line, events, EVENT_BATCH);
+        for (int i = 0; i < count; i++) {
+            ts_ns = events[i].ts.tv_sec * 1000000000LL + events[i].ts.tv_nsec;
+
+            // 이 에지 전에 10ms 동안 그대로였으면 그 값은 안정된 것 (창 안의 되튐은 버림)
+            if (pending && ts_ns - last_ns >= DEBOUNCE_NS && raw_val != val) {
+                val = raw_val;
+                gpiod_line_set_value(led_line, val);
+            }
+            pending = true;
+            last_ns = ts_ns;
+
+            // 에지 방향이 에지 후 값 (상승 1, 하강 0)
+            raw_val = (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE);
+        }
     }
 
     // 5. 정리
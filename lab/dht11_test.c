@@ -1,6 +1,7 @@
 /*
 2026-02-06
 dht11온습도 센서
+응답 파형을 양방향 에지 이벤트로 받아 커널 타임스탬프로 비트 폭 측정
 */
 
 #include <stdio.h>
@@ -10,14 +11,22 @@ dht11온습도 센서
 #include <gpiod.h>
 #include <time.h>
 
-#define MAX_TIMINGS 85
+#define MAX_EDGES 96
 #define DHT_PIN 21
+#define BIT_THRESHOLD_NS 50000LL // HIGH 폭이 50us보다 길면 1 (0: 26~28us, 1: 70us)
 
 int data[5] = { 0, 0, 0, 0, 0 };
+struct gpiod_line_event events[MAX_EDGES];
 
-void read_dht11(struct gpiod_line *line);
+// 통계
+unsigned long reads = 0, successes = 0;
+long long cpu_total_ns = 0, cpu_max_ns = 0;
 
-int main(void) 
+int read_dht11(struct gpiod_line *line);
+int decode_bits(int count);
+long long clock_ns(clockid_t clock);
+
+int main(void)
 {
   struct gpiod_chip *chip;
   struct gpiod_line *line;
@@ -25,70 +34,132 @@ int main(void)
   chip = gpiod_chip_open_by_name("gpiochip0");
   line = gpiod_chip_get_line(chip, DHT_PIN);
 
+  // 라인은 읽기 사이에도 에지 이벤트 입력으로 잡아 둠
+  if (gpiod_line_request_both_edges_events(line, "dht11") < 0)
+  {
+    perror("Request events failed");
+    gpiod_chip_close(chip);
+    return 1;
+  }
+
   printf("DHT11 온습도 측정 시작 (2초 간격)\n");
 
-  while (1) 
+  while (1)
   {
-    read_dht11(line);
+    long long cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    long long cpu_ns;
+    int ok = read_dht11(line);
+
+    cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    reads++;
+    successes += ok;
+    cpu_total_ns += cpu_ns;
+    if (cpu_ns > cpu_max_ns)
+    cpu_max_ns = cpu_ns;
+
+    if (ok)
+    {
+      printf("습도: %d.%d %%  온도: %d.%d C\n", data[0], data[1], data[2], data[3]);
+    }
+    else
+    {
+      printf("데이터 읽기 실패 (재시도 중...)\n");
+    }
+    printf("  성공률 %.1f%% (%lu/%lu), CPU 시간 %.1f us (평균 %.1f us, 최대 %.1f us)\n",
+           100.0 * successes / reads, successes, reads, cpu_ns / 1000.0,
+           cpu_total_ns / 1000.0 / reads, cpu_max_ns / 1000.0);
+
     sleep(2);//안정화
   }
 
   return 0;
 }
 
-void read_dht11(struct gpiod_line *line) 
+int read_dht11(struct gpiod_line *line)
 {
-  uint8_t last_state = 1;
-  uint8_t counter = 0;
-  uint8_t j = 0, i;
+  int count = 0;
+  long long deadline = clock_ns(CLOCK_MONOTONIC) + 10000000LL;   // 응답 전체 10ms 이내
 
   data[0] = data[1] = data[2] = data[3] = data[4] = 0;
 
-  // 1. 시작 신호 보내기 (Output 모드)
-  gpiod_line_release(line); // 기존 설정 해제 후 다시 요청
-  gpiod_line_request_output(line, "dht11", 1);
-  gpiod_line_set_value(line, 0);
+  // 1. 시작 신호 보내기 (출력 LOW로 18ms)
+  // libgpiod v1의 이벤트 요청은 입력 전용이라 이때만 출력으로 다시 요청
+  gpiod_line_release(line);
+  if (gpiod_line_request_output(line, "dht11", 0) < 0)
+  {
+    gpiod_line_request_both_edges_events(line, "dht11");
+    return 0;
+  }
   usleep(18000); // 최소 18ms 유지
-  gpiod_line_set_value(line, 1);
-  usleep(40);
-    
-  // 2. 응답 받기 (Input 모드 전환)
+
+  // 2. 응답 받기 (에지 이벤트 입력으로 복귀, 풀업이 라인을 올림)
   gpiod_line_release(line);
-  gpiod_line_request_input(line, "dht11");
+  if (gpiod_line_request_both_edges_events(line, "dht11") < 0)
+  return 0;
 
-  // 3. 데이터 읽기 (타이밍 체크)
-  for (i = 0; i < MAX_TIMINGS; i++) 
+  // 3. 에지 모으기 (커널 버퍼 16개가 넘치기 전에 여러 개씩 읽음)
+  while (count < MAX_EDGES)
   {
-    counter = 0;
-    while (gpiod_line_get_value(line) == last_state) 
-    {
-      counter++;
-      usleep(1);
-      if (counter == 255)
-      break;
-    }
-    last_state = gpiod_line_get_value(line);
+    long long wait = deadline - clock_ns(CLOCK_MONOTONIC);
+    struct timespec timeout;
+    int ret;
 
-    if (counter == 255) 
+    if (count > 0 && wait > 1000000LL) // 첫 에지 후 1ms 조용하면 끝
+    wait = 1000000LL;
+    if (wait <= 0)
     break;
+    timeout.tv_sec = wait / 1000000000LL;
+    timeout.tv_nsec = wait % 1000000000LL;
 
-    // 앞의 3개 신호는 무시하고 데이터 비트만 추출
-    if ((i >= 4) && (i % 2 == 0)) 
-    {
-      data[j / 8] <<= 1;
-      if (counter > 16) // 신호가 길면 1, 짧으면 0 (시스템 성능에 따라 보정 필요)
-      data[j / 8] |= 1;
-      j++;
-    }
+    if (gpiod_line_event_wait(line, &timeout) <= 0)
+    break;
+    ret = gpiod_line_event_read_multiple(line, &events[count], MAX_EDGES - count);
+    if (ret <= 0)
+    break;
+    count += ret;
   }
 
-  // 40비트 다 읽고 체크섬 확인
-  if ((j >= 40) && (data[4] == ((data[0] + data[1] + data[2] + data[3]) & 0xFF))) 
-  {
-    printf("습도: %d.%d %%  온도: %d.%d C\n", data[0], data[1], data[2], data[3]);
-  }
-  else 
+  // 4. 40비트 해석 후 체크섬 확인
+  return decode_bits(count) &&
+         data[4] == ((data[0] + data[1] + data[2] + data[3]) & 0xFF);
+}
+
+// 상승~하강 에지 사이 HIGH 폭으로 비트 판정, 마지막 40비트만 사용
+// (응답 신호의 80us HIGH를 받았는지와 상관없이 같은 결과)
+int decode_bits(int count)
+{
+  long long rise = -1;
+  uint64_t bits = 0;
+  int nbits = 0, i;
+
+  for (i = 0; i < count; i++)
   {
-    printf("데이터 읽기 실패 (재시도 중...)\n");
+    long long ts = events[i].ts.tv_sec * 1000000000LL + events[i].ts.tv_nsec;
+
+    if (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE)
+    {
+      rise = ts;
+    }
+    else if (rise >= 0)
+    {
+      bits = (bits << 1) | (ts - rise > BIT_THRESHOLD_NS);
+      nbits++;
+      rise = -1;
+    }
   }
-}
\ No newline at end of file
+
+  if (nbits < 40)
+  return 0;
+
+  for (i = 0; i < 5; i++)
+  data[i] = (bits >> (32 - 8 * i)) & 0xFF;
+  return 1;
+}
+
+long long clock_ns(clockid_t clock)
+{
+  struct timespec ts;
+
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
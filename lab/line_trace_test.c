@@ -1,6 +1,8 @@
 /*
 2026-02-06
 라인 트레이더 테스트
+2026-10-16 100ms 폴링 대신 양방향 에지 이벤트로 전이만 출력
+           (입력이 없으면 깨어나지 않고, 100ms보다 짧은 통과도 커널 타임스탬프로 남음)
 */
 
 #include <stdio.h>
@@ -9,6 +11,8 @@
 #include <stdbool.h>
 #include <gpiod.h>
 
+#define EVENT_BATCH 16   // 한 번에 읽는 최대 이벤트 수 (커널 버퍼 크기)
+
 void check_error(int is_error, int *pn);
 
 int main(void)
@@ -19,6 +23,8 @@ int main(void)
 
   struct gpiod_chip *chip;
   struct gpiod_line *ir;
+  struct gpiod_line_event events[EVENT_BATCH];
+  int count;
 
   chip = gpiod_chip_open_by_name(chipname);
   error_code = 1;
@@ -29,22 +35,27 @@ int main(void)
   check_error(ir == NULL, &error_code);
 
   error_code = 3;
-  check_error(gpiod_line_request_input(ir, "line_trace_test") < 0 , &error_code);
+  check_error(gpiod_line_request_both_edges_events(ir, "line_trace_test") < 0 , &error_code);
 
   printf("ir_line_trace_test\n");
+  gpiod_line_get_value(ir) == true ? printf("true\n") : printf("false\n");
 
   while(true)
   {
-    gpiod_line_get_value(ir) == true ? printf("true\n") : printf("false\n");
-    /*
-    if(gpiod_line_get_value(ir) == true)
-    printf("true\n");
-
-    else if(gpiod_line_get_value(ir) == false)
-    printf("false\n");
-    */
+    // 에지가 올 때까지 잠듦 (타임아웃 없음)
+    if (gpiod_line_event_wait(ir, NULL) <= 0)
+    {
+      perror("event wait failed");
+      break;
+    }
 
-    usleep(100000);
+    count = gpiod_line_event_read_multiple(ir, events, EVENT_BATCH);
+    for (int i = 0; i < count; i++)
+    {
+      printf("%s (%ld.%06ld s)\n",
+             events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE ? "true" : "false",
+             (long)events[i].ts.tv_sec, events[i].ts.tv_nsec / 1000);
+    }
   }
 
   gpiod_line_release(ir);
@@ -68,7 +79,7 @@ void check_error(int is_error, int *pn)
       break;
 
       case 3:
-      perror("Error: Input Request Failed");
+      perror("Error: Edge Event Request Failed");
       break;
     }
 
@@ -12,6 +12,9 @@
 #include <sqlite3.h>
 #include <signal.h>
 
+// 에코 대기 마감 시간: 400cm 왕복(약 23.3ms) + 에코 상승 여유 2ms
+#define ECHO_DEADLINE_NS (2000000LL + (long long)(2.0 * 400.0 / 34300.0 * 1e9))
+
 // 전역 변수 (시그널 핸들러용)
 volatile bool running = true;
 
@@ -26,16 +29,19 @@ int main(void)
 
     struct gpiod_chip *chip;
     struct gpiod_line *trig, *echo;
-    struct timespec start, end;
+    struct timespec start = { 0, 0 }, end = { 0, 0 };
+    struct timespec now, trig_time;
+    struct gpiod_line_event event;
+    bool got_rise, got_fall;
+    long long left_ns;
 
     int error_code = 0;
     int ret = 0;
     int num = 0;
-    int timeout_count = 0;
 
     sqlite3 *db;
+    sqlite3_stmt *insert_stmt;
     char *err_msg = NULL;
-    char sql[256];
     
     // Ctrl+C 시그널 핸들러 등록
     signal(SIGINT, signal_handler);
@@ -60,6 +66,16 @@ int main(void)
         exit(1);
     }
 
+    // INSERT 문은 한 번만 준비하고, 측정마다 값만 바인딩해서 실행
+    rc = sqlite3_prepare_v2(db,
+            "INSERT INTO ultrasonic(measurement_num, distance) VALUES(?, ?);",
+            -1, &insert_stmt, NULL);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        exit(1);
+    }
+
     // GPIO 칩 열기
     chip = gpiod_chip_open_by_name(chipname);
     error_code = 1;
@@ -80,8 +96,8 @@ int main(void)
     error_code = 4;
     check_error(ret < 0, &error_code);
 
-    // 에코를 입력으로 설정
-    ret = gpiod_line_request_input(echo, "echo");
+    // 에코를 양방향 에지 이벤트로 설정 (커널 타임스탬프로 펄스 폭 측정)
+    ret = gpiod_line_request_both_edges_events(echo, "echo");
     error_code = 5;
     check_error(ret < 0, &error_code);
 
@@ -94,6 +110,12 @@ int main(void)
         usleep(60000);
         num++;
 
+        // 지난 측정의 마감 뒤에 늦게 온 에지가 남아 있으면 이번 에코로 착각하므로 먼저 비움
+        while (gpiod_line_event_wait(echo, &(struct timespec){ 0, 0 }) > 0) {
+            if (gpiod_line_event_read(echo, &event) < 0)
+                break;
+        }
+
         // 트리거 신호 발생 (10us 펄스)
         gpiod_line_set_value(trig, 0);
         usleep(2);
@@ -101,43 +123,43 @@ int main(void)
         usleep(10);
         gpiod_line_set_value(trig, 0);
 
-        // 에코 신호 HIGH 대기
-        timeout_count = 0;
-        while(gpiod_line_get_value(echo) == 0)
-        {
-            usleep(1);
-            if(++timeout_count > 30000)
-            {
-                printf("Error: Echo timeout (waiting for HIGH)\n");
-                break;
-            }
-        }
-
-        if(timeout_count > 30000) {
-            continue; // 타임아웃 시 다음 측정으로
-        }
-
-        // 에코 신호 시작 시간 기록
-        clock_gettime(CLOCK_MONOTONIC, &start);
+        // 트리거 시점부터 마감 시간까지 에코 에지 이벤트 대기
+        // 상승 에지 = 초음파 발사, 하강 에지 = 반사파 수신
+        clock_gettime(CLOCK_MONOTONIC, &trig_time);
+        left_ns = ECHO_DEADLINE_NS;
+        got_rise = false;
+        got_fall = false;
 
-        // 에코 신호 LOW 대기
-        timeout_count = 0;
-        while(gpiod_line_get_value(echo) == 1)
+        while (!got_fall && left_ns > 0)
         {
-            usleep(1);
-            if(++timeout_count > 30000)
-            {
-                printf("Error: Echo timeout (waiting for LOW)\n");
+            struct timespec wait_ts = { left_ns / 1000000000LL, left_ns % 1000000000LL };
+
+            if (gpiod_line_event_wait(echo, &wait_ts) <= 0)
                 break;
+            if (gpiod_line_event_read(echo, &event) < 0)
+                break;
+
+            if (event.event_type == GPIOD_LINE_EVENT_RISING_EDGE && !got_rise) {
+                start = event.ts;
+                got_rise = true;
+            } else if (event.event_type == GPIOD_LINE_EVENT_FALLING_EDGE && got_rise) {
+                end = event.ts;
+                got_fall = true;
             }
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            left_ns = ECHO_DEADLINE_NS - ((now.tv_sec - trig_time.tv_sec) * 1000000000LL +
+                                          (now.tv_nsec - trig_time.tv_nsec));
         }
 
-        if(timeout_count > 30000) {
+        if (!got_rise) {
+            printf("Error: Echo timeout (waiting for HIGH)\n");
             continue; // 타임아웃 시 다음 측정으로
         }
-
-        // 에코 신호 종료 시간 기록
-        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!got_fall) {
+            printf("Error: Echo timeout (waiting for LOW)\n");
+            continue;
+        }
 
         // 거리 계산
         double time_sec = (end.tv_sec - start.tv_sec) + 
@@ -148,16 +170,13 @@ int main(void)
         if(distance >= 2.0 && distance <= 400.0) {
             printf("[%d] 거리: %.2f cm\n", num, distance);
             
-            // SQLite에 데이터 저장
-            snprintf(sql, sizeof(sql), 
-                    "INSERT INTO ultrasonic(measurement_num, distance) VALUES(%d, %.2f);",
-                    num, distance);
-            
-            rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
-            if (rc != SQLITE_OK) {
-                fprintf(stderr, "SQL error: %s\n", err_msg);
-                sqlite3_free(err_msg);
+            // SQLite에 데이터 저장 (bind → step → reset)
+            sqlite3_bind_int(insert_stmt, 1, num);
+            sqlite3_bind_double(insert_stmt, 2, distance);
+            if (sqlite3_step(insert_stmt) != SQLITE_DONE) {
+                fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
             }
+            sqlite3_reset(insert_stmt);
         } else {
             printf("[%d] 측정 범위 초과: %.2f cm\n", num, distance);
         }
@@ -171,6 +190,7 @@ int main(void)
     gpiod_line_release(trig);
     gpiod_line_release(echo);
     gpiod_chip_close(chip);
+    sqlite3_finalize(insert_stmt);
     sqlite3_close(db);
     
     printf("총 %d개의 측정값이 저장되었습니다.\n", num);
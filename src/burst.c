@@ -0,0 +1,122 @@
+/*
+파일명: burst.c
+작성일: 2026-10-16
+설명: 버스트 측정 (한 번의 측정에 K번 핑)
+      엉뚱한 반사 한두 개가 섞여도 중앙값은 흔들리지 않음
+      K가 작으므로 삽입 정렬로 핑마다 O(K), 메모리는 구조체 안의 배열뿐
+ */
+
+#include <stdio.h>
+#include "ultrasonic.h"
+#include "burst.h"
+
+// ========== 초기화 ==========
+// size는 1 ~ BURST_MAX로 제한
+void burst_init(struct burst *b, int size)
+{
+  if (size < 1)
+  {
+    size = 1;
+  }
+  else if (size > BURST_MAX)
+  {
+    size = BURST_MAX;
+  }
+  b->size = size;
+  b->reduced = 0;
+  b->rejected = 0;
+  b->pings = 0;
+  b->first_done_ns = 0;
+  b->last_done_ns = 0;
+  b->duration_total_ns = 0;
+  burst_begin(b, 0);
+}
+
+// ========== 새 버스트 시작 ==========
+void burst_begin(struct burst *b, int64_t start_ns)
+{
+  b->count = 0;
+  b->valid = 0;
+  b->last_error = US_TIMEOUT_HIGH;
+  b->started_ns = start_ns;
+}
+
+// ========== 핑 결과 추가 ==========
+// 유효 펄스는 정렬된 자리에 끼워 넣음. K번째 핑이면 true
+bool burst_add(struct burst *b, int status, int64_t pulse_ns)
+{
+  b->count++;
+  b->pings++;
+
+  if (status != US_OK)
+  {
+    b->last_error = status;
+    return b->count >= b->size;
+  }
+
+  int i = b->valid++;
+  while (i > 0 && b->sorted[i - 1] > pulse_ns)
+  {
+    b->sorted[i] = b->sorted[i - 1];
+    i--;
+  }
+  b->sorted[i] = pulse_ns;
+  return b->count >= b->size;
+}
+
+// ========== 버스트를 측정값 하나로 ==========
+// 유효 핑이 절반 이상이면 중앙값과 IQR(유효 2개 미만이면 -1)을 돌려주고 US_OK
+// 아니면 마지막 실패 코드 (타임아웃이 다수면 측정 실패로 봄)
+int burst_reduce(struct burst *b, int64_t now_ns, int64_t *median_ns, int64_t *spread_ns)
+{
+  int v = b->valid;
+
+  b->duration_total_ns += now_ns - b->started_ns;
+  if (b->first_done_ns == 0)
+  {
+    b->first_done_ns = now_ns;
+  }
+  b->last_done_ns = now_ns;
+
+  if (v == 0 || v * 2 < b->size)
+  {
+    b->rejected++;
+    return b->last_error;
+  }
+
+  if (v % 2 == 1)
+  {
+    *median_ns = b->sorted[v / 2];
+  }
+  else
+  {
+    *median_ns = (b->sorted[v / 2 - 1] + b->sorted[v / 2]) / 2;
+  }
+  *spread_ns = (v >= 2) ? b->sorted[v - 1 - v / 4] - b->sorted[v / 4] : -1;
+
+  b->reduced++;
+  return US_OK;
+}
+
+// ========== 버스트 처리량 통계 출력 ==========
+void burst_print_stats(const struct burst *b)
+{
+  uint64_t measurements = b->reduced + b->rejected;
+  double elapsed_s = (b->last_done_ns - b->first_done_ns) / 1e9;
+
+  if (b->size <= 1 || measurements == 0)
+  {
+    return;
+  }
+
+  printf("버스트 측정 (K=%d): 측정 %llu회 (중앙값 %llu, 유효 핑 부족 %llu), 핑 %llu회\n",
+         b->size, (unsigned long long)measurements, (unsigned long long)b->reduced,
+         (unsigned long long)b->rejected, (unsigned long long)b->pings);
+  printf("버스트 소요: 평균 %.1f ms", b->duration_total_ns / 1e6 / measurements);
+  if (measurements >= 2 && elapsed_s > 0)
+  {
+    printf(", 처리량 %.2f 측정/s", (measurements - 1) / elapsed_s);
+  }
+  // 버스트를 쉬지 않고 이어서 돌렸을 때의 상한
+  printf(" (최대 %.1f 측정/s)\n", 1e9 * measurements / b->duration_total_ns);
+}
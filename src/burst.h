@@ -0,0 +1,43 @@
+/*
+파일명: burst.h
+작성일: 2026-10-16
+설명: 버스트 측정 (한 번의 측정에 K번 핑)
+      유효 펄스 폭을 고정 크기 배열에 정렬 상태로 끼워 넣고
+      중앙값과 사분위 범위(IQR)로 줄임 (동적 할당 없음)
+ */
+
+#ifndef BURST_H
+#define BURST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 최대 K: 에코가 없어 핑마다 60ms를 다 써도 결과 유지 시간(2초) 안에 끝나는 크기
+#define BURST_MAX 15
+
+// ========== 버스트 상태 ==========
+struct burst
+{
+  int size;                   // K (1이면 단일 핑과 같음)
+  int count;                  // 이번 버스트에서 쏜 핑 수
+  int valid;                  // 그중 에코를 받은 핑 수
+  int last_error;             // 마지막 실패 핑의 상태 코드
+  int64_t sorted[BURST_MAX];  // 유효 펄스 폭 (오름차순)
+  int64_t started_ns;         // 이번 버스트 첫 핑 예약 시각
+
+  // 통계 (측정 스레드만 씀, 종료 후 읽기)
+  uint64_t reduced;           // 중앙값을 낸 측정 수
+  uint64_t rejected;          // 유효 핑이 절반 미만이라 버린 측정 수
+  uint64_t pings;
+  int64_t first_done_ns;
+  int64_t last_done_ns;
+  int64_t duration_total_ns;  // 첫 핑 예약 → 마지막 에코까지
+};
+
+void burst_init(struct burst *b, int size);
+void burst_begin(struct burst *b, int64_t start_ns);
+bool burst_add(struct burst *b, int status, int64_t pulse_ns);
+int burst_reduce(struct burst *b, int64_t now_ns, int64_t *median_ns, int64_t *spread_ns);
+void burst_print_stats(const struct burst *b);
+
+#endif
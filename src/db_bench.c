@@ -0,0 +1,218 @@
+/*
+파일명: db_bench.c
+작성일: 2026-10-16
+설명: 기존 스키마(ultrasonic)와 압축 스키마(samples) 비교 벤치마크
+      사용법: ./db_bench [행 수, 기본 100000]
+      50Hz 측정을 흉내 낸 같은 데이터를 두 스키마에 넣고
+      삽입 속도, 페이지당 행 수, 최근 N행 / 1분 구간 조회 속도를 비교
+      삽입은 묶음 모드와 같이 WAL + synchronous=NORMAL, 100행마다 커밋
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sqlite3.h>
+#include "storage.h"
+#include "event_loop.h"
+
+#define BENCH_BATCH 100               // 한 트랜잭션의 행 수
+#define BENCH_PERIOD_NS 20000000LL    // 측정 간격 (50Hz)
+#define BENCH_QUERIES 200             // 조회 반복 횟수
+#define BENCH_RECENT 1000             // 최근 N행 조회
+#define BENCH_WINDOW_NS 60000000000LL // 구간 조회 길이 (1분)
+#define BENCH_EPOCH_NS 1791000000000000000LL  // 첫 측정 시각 (2026-10 무렵)
+
+// ========== 스키마별 설정 ==========
+struct bench_schema
+{
+  const char *name;
+  const char *path;
+  const char *create_sql;
+  const char *insert_sql;
+  const char *recent_sql;
+  const char *window_sql;
+  bool compact;
+};
+
+static const struct bench_schema schemas[] =
+{
+  {
+    "기존 (ultrasonic)", "db_bench_legacy.db", STORAGE_LEGACY_TABLE_SQL,
+    // 실제로는 timestamp가 기본값이지만 구간 조회를 위해 같은 시각을 텍스트로 넣음
+    "INSERT INTO ultrasonic(measurement_num, distance, ir_triggered, distance_spread, sensor_id, timestamp) "
+    "VALUES(?, ?, ?, NULL, 0, ?);",
+    "SELECT AVG(distance) FROM (SELECT distance FROM ultrasonic ORDER BY id DESC LIMIT ?);",
+    "SELECT COUNT(*), AVG(distance) FROM ultrasonic WHERE timestamp >= ? AND timestamp < ?;",
+    false
+  },
+  {
+    "압축 (samples)", "db_bench_compact.db", STORAGE_COMPACT_TABLE_SQL,
+    "INSERT INTO samples(ts_ns, sensor_id, distance_01mm, spread_01mm, measurement_num, ir_triggered) "
+    "VALUES(?, 0, ?, NULL, ?, ?);",
+    "SELECT AVG(distance_01mm) FROM (SELECT distance_01mm FROM samples ORDER BY ts_ns DESC LIMIT ?);",
+    "SELECT COUNT(*), AVG(distance_01mm) FROM samples WHERE ts_ns >= ? AND ts_ns < ?;",
+    true
+  },
+};
+
+static void run_schema(const struct bench_schema *sc, int rows);
+static void bind_time(sqlite3_stmt *stmt, int index, int64_t ts_ns, bool compact);
+static int64_t distance_01mm(int i);
+
+int main(int argc, char *argv[])
+{
+  int rows = (argc > 1) ? atoi(argv[1]) : 100000;
+
+  if (rows < BENCH_RECENT)
+  {
+    fprintf(stderr, "행 수는 %d 이상\n", BENCH_RECENT);
+    return 1;
+  }
+
+  printf("%d행 (50Hz, %d행마다 커밋), 조회 %d회씩\n\n", rows, BENCH_BATCH, BENCH_QUERIES);
+  for (size_t i = 0; i < sizeof(schemas) / sizeof(schemas[0]); i++)
+  {
+    run_schema(&schemas[i], rows);
+  }
+  return 0;
+}
+
+// ========== 스키마 하나 측정 ==========
+static void run_schema(const struct bench_schema *sc, int rows)
+{
+  sqlite3 *db = NULL;
+  sqlite3_stmt *insert = NULL, *recent = NULL, *window = NULL;
+  int64_t start_ns, insert_ns, recent_ns, window_ns;
+  int64_t pages, page_size, window_rows = 0;
+
+  unlink(sc->path);
+  if (sqlite3_open(sc->path, &db) != SQLITE_OK ||
+      storage_exec(db, "PRAGMA journal_mode=WAL;") < 0 ||
+      storage_exec(db, "PRAGMA synchronous=NORMAL;") < 0 ||
+      storage_exec(db, sc->create_sql) < 0 ||
+      sqlite3_prepare_v2(db, sc->insert_sql, -1, &insert, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(db, sc->recent_sql, -1, &recent, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(db, sc->window_sql, -1, &window, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_close(db);
+    exit(1);
+  }
+
+  // ========== 삽입 ==========
+  start_ns = monotonic_ns();
+  for (int i = 0; i < rows; i++)
+  {
+    int64_t ts_ns = BENCH_EPOCH_NS + i * BENCH_PERIOD_NS;
+
+    if (i % BENCH_BATCH == 0)
+    {
+      storage_exec(db, "BEGIN;");
+    }
+    if (sc->compact)
+    {
+      bind_time(insert, 1, ts_ns, true);
+      sqlite3_bind_int64(insert, 2, distance_01mm(i));
+      sqlite3_bind_int(insert, 3, i);
+      sqlite3_bind_int(insert, 4, 0);
+    }
+    else
+    {
+      sqlite3_bind_int(insert, 1, i);
+      sqlite3_bind_double(insert, 2, distance_01mm(i) * 0.01);
+      sqlite3_bind_int(insert, 3, 0);
+      bind_time(insert, 4, ts_ns, false);
+    }
+    if (sqlite3_step(insert) != SQLITE_DONE)
+    {
+      fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+      exit(1);
+    }
+    sqlite3_reset(insert);
+    if (i % BENCH_BATCH == BENCH_BATCH - 1 || i == rows - 1)
+    {
+      storage_exec(db, "COMMIT;");
+    }
+  }
+  insert_ns = monotonic_ns() - start_ns;
+
+  // WAL 내용을 본 파일로 옮긴 뒤 페이지 수를 셈
+  storage_exec(db, "PRAGMA wal_checkpoint(TRUNCATE);");
+  {
+    sqlite3_stmt *stmt = NULL;
+
+    sqlite3_prepare_v2(db, "SELECT page_count, page_size FROM pragma_page_count, pragma_page_size;",
+                       -1, &stmt, NULL);
+    sqlite3_step(stmt);
+    pages = sqlite3_column_int64(stmt, 0);
+    page_size = sqlite3_column_int64(stmt, 1);
+    sqlite3_finalize(stmt);
+  }
+
+  // ========== 최근 N행 평균 ==========
+  start_ns = monotonic_ns();
+  for (int q = 0; q < BENCH_QUERIES; q++)
+  {
+    sqlite3_bind_int(recent, 1, BENCH_RECENT);
+    sqlite3_step(recent);
+    sqlite3_reset(recent);
+  }
+  recent_ns = monotonic_ns() - start_ns;
+
+  // ========== 1분 구간 개수 / 평균 (구간은 매번 다른 위치) ==========
+  start_ns = monotonic_ns();
+  for (int q = 0; q < BENCH_QUERIES; q++)
+  {
+    int64_t span_ns = (int64_t)rows * BENCH_PERIOD_NS - BENCH_WINDOW_NS;
+    int64_t from_ns = BENCH_EPOCH_NS + (span_ns > 0 ? span_ns / BENCH_QUERIES * q : 0);
+
+    bind_time(window, 1, from_ns, sc->compact);
+    bind_time(window, 2, from_ns + BENCH_WINDOW_NS, sc->compact);
+    if (sqlite3_step(window) == SQLITE_ROW)
+    {
+      window_rows += sqlite3_column_int64(window, 0);
+    }
+    sqlite3_reset(window);
+  }
+  window_ns = monotonic_ns() - start_ns;
+
+  printf("%s\n", sc->name);
+  printf("  삽입: %.0f rows/s (%.2f us/행)\n", rows / (insert_ns / 1e9), insert_ns / 1000.0 / rows);
+  printf("  크기: %lld 페이지 x %lld 바이트 = %.1f KB, 페이지당 %.1f행, 행당 %.1f 바이트\n",
+         (long long)pages, (long long)page_size, pages * page_size / 1024.0,
+         (double)rows / pages, (double)pages * page_size / rows);
+  printf("  최근 %d행 평균: %.1f us/회\n", BENCH_RECENT, recent_ns / 1000.0 / BENCH_QUERIES);
+  printf("  1분 구간 조회: %.1f us/회 (평균 %lld행)\n\n", window_ns / 1000.0 / BENCH_QUERIES,
+         (long long)(window_rows / BENCH_QUERIES));
+
+  sqlite3_finalize(insert);
+  sqlite3_finalize(recent);
+  sqlite3_finalize(window);
+  sqlite3_close(db);
+  unlink(sc->path);
+}
+
+// ========== 시각 바인딩 ==========
+// 압축 스키마는 ns 정수, 기존 스키마는 DATETIME 텍스트 (초 단위, UTC)
+static void bind_time(sqlite3_stmt *stmt, int index, int64_t ts_ns, bool compact)
+{
+  char text[32];
+  time_t sec = ts_ns / 1000000000LL;
+  struct tm tm;
+
+  if (compact)
+  {
+    sqlite3_bind_int64(stmt, index, ts_ns);
+    return;
+  }
+  gmtime_r(&sec, &tm);
+  strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm);
+  sqlite3_bind_text(stmt, index, text, -1, SQLITE_TRANSIENT);
+}
+
+// ========== 가짜 거리 (2cm ~ 400cm, 0.1mm) ==========
+static int64_t distance_01mm(int i)
+{
+  return 200 + (int64_t)(i * 2654435761u % 39800u);
+}
@@ -0,0 +1,256 @@
+/*
+파일명: db_load.c
+작성일: 2026-10-16
+설명: 바이너리 로그(-S) 세그먼트 → ultrasonic 테이블 일괄 적재 도구
+      사용법: ./db_load [-k] 로그 디렉터리 [DB 파일, 기본 ultrasonic.db]
+      -k: 옮긴 세그먼트 파일을 지우지 않고 남김
+      닫힌 세그먼트마다 한 트랜잭션으로 CRC가 맞는 레코드만 넣고 (요약 테이블이 있으면 함께 갱신)
+      옮긴 세그먼트 id(만든 시각 ns)를 같은 트랜잭션에서 log_loaded에 적으므로 중간에 끊겨도 두 번 들어가지 않음
+      로거가 쓰는 중인 세그먼트는 건너뜀 (열린 채 끝났으면 로거를 다시 켤 때 복구되어 닫힘)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sqlite3.h>
+#include "storage.h"
+#include "sample_log.h"
+#include "event_loop.h"
+
+// seq 열에는 세그먼트 id를 적음 (예전 DB와 같은 테이블을 그대로 씀)
+#define LOADED_TABLE_SQL \
+  "CREATE TABLE IF NOT EXISTS log_loaded(" \
+  "seq INTEGER PRIMARY KEY, " \
+  "records INTEGER, " \
+  "loaded_at DATETIME DEFAULT CURRENT_TIMESTAMP);"
+
+// ========== 적재에 쓰는 준비된 문장 ==========
+struct loader
+{
+  sqlite3 *db;
+  sqlite3_stmt *insert;
+  sqlite3_stmt *minute;    // 요약 테이블이 없으면 NULL (로거가 처음 열 때 전체로 채움)
+  sqlite3_stmt *hour;
+  sqlite3_stmt *loaded;    // 이미 옮긴 세그먼트인지
+  sqlite3_stmt *mark;      // 옮긴 세그먼트 기록
+};
+
+static int load_segment(struct loader *ld, const struct sample_log_segment *seg);
+static int step_rollup(sqlite3_stmt *stmt, int64_t bucket, const struct sample_log_record *rec);
+
+int main(int argc, char *argv[])
+{
+  const char *dir;
+  const char *path = "ultrasonic.db";
+  struct loader ld = { NULL, NULL, NULL, NULL, NULL, NULL };
+  struct dirent **list;
+  sqlite3_stmt *probe = NULL;
+  bool keep = false;
+  int count, loaded = 0, skipped = 0, rc = 0;
+  int64_t records = 0, start_ns, elapsed_ns;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "kh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'k':
+        keep = true;
+        break;
+      default:
+        printf("사용법: %s [-k] 로그 디렉터리 [DB 파일]\n", argv[0]);
+        printf("  -k  옮긴 세그먼트 파일을 지우지 않음\n");
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (optind >= argc)
+  {
+    printf("사용법: %s [-k] 로그 디렉터리 [DB 파일]\n", argv[0]);
+    return 1;
+  }
+  dir = argv[optind];
+  if (optind + 1 < argc)
+  {
+    path = argv[optind + 1];
+  }
+
+  if (sqlite3_open(path, &ld.db) != SQLITE_OK)
+  {
+    fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(ld.db));
+    sqlite3_close(ld.db);
+    return 1;
+  }
+  sqlite3_busy_timeout(ld.db, 5000);
+
+  if (storage_exec(ld.db, STORAGE_LEGACY_TABLE_SQL) < 0 || storage_exec(ld.db, LOADED_TABLE_SQL) < 0)
+  {
+    sqlite3_close(ld.db);
+    return 1;
+  }
+
+  // 시각은 기본값(적재 시각) 대신 레코드의 측정 시각을 CURRENT_TIMESTAMP와 같은 UTC 텍스트로
+  if (sqlite3_prepare_v2(ld.db,
+                         "INSERT INTO ultrasonic(measurement_num, distance, ir_triggered, timestamp, "
+                         "distance_spread, sensor_id) VALUES(?1, ?2, ?3, datetime(?4, 'unixepoch'), ?5, ?6);",
+                         -1, &ld.insert, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(ld.db));
+    fprintf(stderr, "오래된 DB면 로거를 한 번 실행해 distance_spread, sensor_id 열을 추가하세요\n");
+    sqlite3_close(ld.db);
+    return 1;
+  }
+  if (sqlite3_prepare_v2(ld.db, "SELECT bucket FROM rollup_minute LIMIT 0;", -1, &probe, NULL) == SQLITE_OK)
+  {
+    sqlite3_prepare_v2(ld.db, STORAGE_ROLLUP_UPSERT_SQL("rollup_minute"), -1, &ld.minute, NULL);
+    sqlite3_prepare_v2(ld.db, STORAGE_ROLLUP_UPSERT_SQL("rollup_hour"), -1, &ld.hour, NULL);
+  }
+  sqlite3_finalize(probe);
+  sqlite3_prepare_v2(ld.db, "SELECT 1 FROM log_loaded WHERE seq = ?;", -1, &ld.loaded, NULL);
+  sqlite3_prepare_v2(ld.db, "INSERT INTO log_loaded(seq, records) VALUES(?, ?);", -1, &ld.mark, NULL);
+
+  count = sample_log_scan(dir, &list);
+  if (count < 0)
+  {
+    perror(dir);
+    rc = 1;
+    count = 0;
+    list = NULL;
+  }
+
+  start_ns = monotonic_ns();
+  for (int i = 0; i < count && rc == 0; i++)
+  {
+    struct sample_log_segment seg;
+    char seg_path[SAMPLE_LOG_PATH_MAX];
+    bool done = false;
+
+    snprintf(seg_path, sizeof(seg_path), "%s/%s", dir, list[i]->d_name);
+    if (sample_log_segment_open(&seg, seg_path) < 0)
+    {
+      skipped++;
+      continue;
+    }
+
+    if (!seg.closed)
+    {
+      printf("%s: 쓰는 중이라 건너뜀\n", list[i]->d_name);
+      skipped++;
+    }
+    else
+    {
+      sqlite3_bind_int64(ld.loaded, 1, seg.header->id);
+      done = (sqlite3_step(ld.loaded) == SQLITE_ROW);
+      sqlite3_reset(ld.loaded);
+
+      if (done)
+      {
+        printf("%s: 이미 옮김\n", list[i]->d_name);
+      }
+      else if (load_segment(&ld, &seg) < 0)
+      {
+        rc = 1;
+      }
+      else
+      {
+        printf("%s: %u행%s\n", list[i]->d_name, seg.valid,
+               (seg.valid < seg.header->closed_count || seg.torn) ? " (CRC가 맞지 않는 뒷부분 버림)" : "");
+        records += seg.valid;
+        loaded++;
+        done = true;
+      }
+    }
+    sample_log_segment_close(&seg);
+
+    if (done && !keep && unlink(seg_path) < 0)
+    {
+      perror(seg_path);
+    }
+  }
+  elapsed_ns = monotonic_ns() - start_ns;
+
+  printf("%s → %s: 세그먼트 %d개, %lld행 (%.0f rows/s), 건너뜀 %d개%s\n", dir, path, loaded,
+         (long long)records, elapsed_ns > 0 ? records / (elapsed_ns / 1e9) : 0.0, skipped,
+         ld.minute != NULL ? ", 요약 테이블 갱신" : "");
+
+  if (list != NULL)
+  {
+    sample_log_free(list, count);
+  }
+  sqlite3_finalize(ld.insert);
+  sqlite3_finalize(ld.minute);
+  sqlite3_finalize(ld.hour);
+  sqlite3_finalize(ld.loaded);
+  sqlite3_finalize(ld.mark);
+  sqlite3_close(ld.db);
+  return rc;
+}
+
+// ========== 세그먼트 하나를 한 트랜잭션으로 적재 ==========
+static int load_segment(struct loader *ld, const struct sample_log_segment *seg)
+{
+  if (storage_exec(ld->db, "BEGIN;") < 0)
+  {
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < seg->valid; i++)
+  {
+    const struct sample_log_record *rec = &seg->records[i];
+    int64_t ts_s = rec->ts_ns / 1000000000LL;
+    int ir = (rec->flags & SAMPLE_LOG_FLAG_IR) ? 1 : 0;
+    int step;
+
+    sqlite3_bind_int(ld->insert, 1, rec->num);
+    sqlite3_bind_double(ld->insert, 2, rec->distance_01mm * 0.01);
+    sqlite3_bind_int(ld->insert, 3, ir);
+    sqlite3_bind_int64(ld->insert, 4, ts_s);
+    if (rec->spread_01mm >= 0)
+    {
+      sqlite3_bind_double(ld->insert, 5, rec->spread_01mm * 0.01);
+    }
+    else
+    {
+      sqlite3_bind_null(ld->insert, 5);
+    }
+    sqlite3_bind_int(ld->insert, 6, rec->sensor_id);
+    step = sqlite3_step(ld->insert);
+    sqlite3_reset(ld->insert);
+
+    if (step != SQLITE_DONE ||
+        (ld->minute != NULL &&
+         (step_rollup(ld->minute, ts_s / STORAGE_ROLLUP_MINUTE_S, rec) < 0 ||
+          step_rollup(ld->hour, ts_s / STORAGE_ROLLUP_HOUR_S, rec) < 0)))
+    {
+      fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(ld->db));
+      storage_exec(ld->db, "ROLLBACK;");
+      return -1;
+    }
+  }
+
+  sqlite3_bind_int64(ld->mark, 1, seg->header->id);
+  sqlite3_bind_int64(ld->mark, 2, seg->valid);
+  if (sqlite3_step(ld->mark) != SQLITE_DONE)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(ld->db));
+    sqlite3_reset(ld->mark);
+    storage_exec(ld->db, "ROLLBACK;");
+    return -1;
+  }
+  sqlite3_reset(ld->mark);
+
+  return storage_exec(ld->db, "COMMIT;");
+}
+
+// ========== 요약 행 하나 갱신 ==========
+static int step_rollup(sqlite3_stmt *stmt, int64_t bucket, const struct sample_log_record *rec)
+{
+  int rc;
+
+  sqlite3_bind_int64(stmt, 1, bucket);
+  sqlite3_bind_int64(stmt, 2, rec->distance_01mm);
+  sqlite3_bind_int(stmt, 3, (rec->flags & SAMPLE_LOG_FLAG_IR) ? 1 : 0);
+  rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  return (rc == SQLITE_DONE) ? 0 : -1;
+}
@@ -0,0 +1,140 @@
+/*
+파일명: db_migrate.c
+작성일: 2026-10-16
+설명: 기존 ultrasonic 테이블 → 압축 스키마(samples) 일회성 변환 도구
+      사용법: ./db_migrate [-d] [DB 파일, 기본 ultrasonic.db]
+      -d: 옮긴 뒤 ultrasonic 테이블을 지우고 VACUUM으로 파일 크기를 줄임
+      기존 timestamp는 1초 해상도라 초 아래 자리는 id로 채움 (같은 초 안의 순서 유지)
+      이미 옮긴 행은 키가 같아 건너뛰므로 여러 번 실행해도 됨
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include "storage.h"
+
+static int has_column(sqlite3 *db, const char *table, const char *column);
+static int64_t query_int(sqlite3 *db, const char *sql);
+
+int main(int argc, char *argv[])
+{
+  const char *path = "ultrasonic.db";
+  sqlite3 *db = NULL;
+  char sql[1024];
+  bool drop_old = false;
+  int64_t source_rows, before_bytes, after_bytes;
+  int moved;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "dh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'd':
+        drop_old = true;
+        break;
+      default:
+        printf("사용법: %s [-d] [DB 파일]\n", argv[0]);
+        printf("  -d  옮긴 뒤 ultrasonic 테이블 삭제 + VACUUM\n");
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (optind < argc)
+  {
+    path = argv[optind];
+  }
+
+  if (sqlite3_open_v2(path, &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
+    sqlite3_close(db);
+    return 1;
+  }
+  sqlite3_busy_timeout(db, 5000);
+
+  if (!has_column(db, "ultrasonic", "distance"))
+  {
+    fprintf(stderr, "%s에 ultrasonic 테이블이 없습니다\n", path);
+    sqlite3_close(db);
+    return 1;
+  }
+
+  before_bytes = query_int(db, "SELECT page_count * page_size FROM pragma_page_count, pragma_page_size;");
+  source_rows = query_int(db, "SELECT COUNT(*) FROM ultrasonic WHERE distance IS NOT NULL;");
+
+  // 오래된 DB에는 나중에 생긴 열이 없으므로 그 자리는 상수로 채움 (원본은 건드리지 않음)
+  snprintf(sql, sizeof(sql),
+           "INSERT OR IGNORE INTO samples"
+           "(ts_ns, sensor_id, distance_01mm, spread_01mm, measurement_num, ir_triggered) "
+           "SELECT CAST(strftime('%%s', timestamp) AS INTEGER) * 1000000000 + (id %% 1000000) * 1000, "
+           "%s, CAST(round(distance * 100) AS INTEGER), %s, measurement_num, ir_triggered "
+           "FROM ultrasonic WHERE distance IS NOT NULL AND timestamp IS NOT NULL;",
+           has_column(db, "ultrasonic", "sensor_id") ? "COALESCE(sensor_id, 0)" : "0",
+           has_column(db, "ultrasonic", "distance_spread")
+               ? "CAST(round(distance_spread * 100) AS INTEGER)" : "NULL");
+
+  if (storage_exec(db, "BEGIN IMMEDIATE;") < 0 ||
+      storage_exec(db, STORAGE_COMPACT_TABLE_SQL) < 0 ||
+      storage_exec(db, sql) < 0)
+  {
+    storage_exec(db, "ROLLBACK;");
+    sqlite3_close(db);
+    return 1;
+  }
+  moved = sqlite3_changes(db);
+
+  if (drop_old && storage_exec(db, "DROP TABLE ultrasonic;") < 0)
+  {
+    storage_exec(db, "ROLLBACK;");
+    sqlite3_close(db);
+    return 1;
+  }
+  if (storage_exec(db, "COMMIT;") < 0)
+  {
+    sqlite3_close(db);
+    return 1;
+  }
+  if (drop_old)
+  {
+    storage_exec(db, "VACUUM;");
+  }
+
+  after_bytes = query_int(db, "SELECT page_count * page_size FROM pragma_page_count, pragma_page_size;");
+  printf("%s: ultrasonic %lld행 중 %d행을 samples로 옮김 (samples 전체 %lld행)\n",
+         path, (long long)source_rows, moved,
+         (long long)query_int(db, "SELECT COUNT(*) FROM samples;"));
+  printf("파일 크기: %lld → %lld 바이트%s\n", (long long)before_bytes, (long long)after_bytes,
+         drop_old ? " (ultrasonic 삭제 + VACUUM)" : "");
+
+  sqlite3_close(db);
+  return 0;
+}
+
+// ========== 열 존재 확인 ==========
+static int has_column(sqlite3 *db, const char *table, const char *column)
+{
+  sqlite3_stmt *probe = NULL;
+  char sql[128];
+  int found;
+
+  snprintf(sql, sizeof(sql), "SELECT %s FROM %s LIMIT 0;", column, table);
+  found = (sqlite3_prepare_v2(db, sql, -1, &probe, NULL) == SQLITE_OK);
+  sqlite3_finalize(probe);
+  return found;
+}
+
+// ========== 정수 하나 돌려주는 질의 ==========
+static int64_t query_int(sqlite3 *db, const char *sql)
+{
+  sqlite3_stmt *stmt = NULL;
+  int64_t value = -1;
+
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK &&
+      sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    value = sqlite3_column_int64(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  return value;
+}
@@ -0,0 +1,405 @@
+/*
+파일명: db_stats.c
+작성일: 2026-10-16
+설명: 요약(rollup) 테이블로 측정 통계 계산 (make stats)
+      사용법: ./db_stats [-f "YYYY-MM-DD HH:MM"] [-t "YYYY-MM-DD HH:MM"] [-P 디렉터리 | DB 파일]
+      시각은 현지 시각, 분 단위 (끝 시각은 포함하지 않음), 생략하면 전체 기간
+      구간 안의 온전한 시간은 rollup_hour, 앞뒤 남는 분은 rollup_minute에서 읽음
+      읽는 행 수는 원본 행 수가 아니라 구간 길이에 비례: 분 행 최대 118개 + 시간 수만큼
+      (O(시간), 1년이면 시간 행 약 8,760개, 일 단위 요약은 두지 않음)
+      -P: 구간과 겹치는 파티션 파일만 ATTACH해 같은 질의를 UNION ALL로 돌리고 C에서 합침
+          (한 번에 붙일 수 있는 파일 수가 정해져 있어 PARTITION_MAX_ATTACH개씩 나눠 읽음)
+      요약 테이블이 없는 예전 DB 파일은 읽기 전에 기존 행으로 만들어 채움 (쓰기 권한 필요)
+ */
+
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <sqlite3.h>
+#include "storage.h"
+#include "partition.h"
+#include "event_loop.h"
+
+#define FAR_FUTURE_S 32503680000LL   // 3000-01-01 (기간 생략 시 끝)
+
+// ========== 요약 행 합계 (파일/묶음별 결과를 더함) ==========
+struct totals
+{
+  int64_t count;
+  int64_t sum;
+  int64_t sum_sq;
+  int64_t min;
+  int64_t max;
+  int64_t ir_hits;
+  int64_t rows;     // 읽은 요약 행 수
+};
+
+static int ensure_rollups(const char *path);
+static int query_schemas(sqlite3 *db, const char *const *schemas, int count,
+                         const int64_t bounds[6], struct totals *t);
+static int query_partitions(const char *dir, int64_t from_s, int64_t to_s,
+                            const int64_t bounds[6], struct totals *t);
+static int parse_minute(const char *text, int64_t *epoch_s);
+static void format_minute(int64_t epoch_s, char *out, size_t size);
+
+int main(int argc, char *argv[])
+{
+  const char *path = "ultrasonic.db";
+  const char *partition_dir = NULL;
+  const char *main_schema[] = { "main" };
+  int64_t from_s = 0, to_s = FAR_FUTURE_S;
+  int64_t m_from, m_to, h_from, h_to, start_ns, elapsed_ns;
+  int64_t bounds[6];
+  struct totals t = { 0, 0, 0, INT64_MAX, INT64_MIN, 0, 0 };
+  sqlite3 *db = NULL;
+  char from_text[32], to_text[32];
+  int files = 1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "f:t:P:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'f':
+        if (parse_minute(optarg, &from_s) < 0)
+        {
+          return 1;
+        }
+        break;
+      case 't':
+        if (parse_minute(optarg, &to_s) < 0)
+        {
+          return 1;
+        }
+        break;
+      case 'P':
+        partition_dir = optarg;
+        break;
+      default:
+        printf("사용법: %s [-f \"YYYY-MM-DD HH:MM\"] [-t \"YYYY-MM-DD HH:MM\"] [-P 디렉터리 | DB 파일]\n",
+               argv[0]);
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+  if (optind < argc)
+  {
+    path = argv[optind];
+  }
+
+  // ========== 구간을 시간 / 분 조각으로 나누기 ==========
+  // 질의의 ?1~?6: 시간 행 [?1, ?2), 분 행 [?3, ?4) + [?5, ?6)
+  m_from = from_s / STORAGE_ROLLUP_MINUTE_S;
+  m_to = to_s / STORAGE_ROLLUP_MINUTE_S;
+  h_from = (from_s + STORAGE_ROLLUP_HOUR_S - 1) / STORAGE_ROLLUP_HOUR_S;
+  h_to = to_s / STORAGE_ROLLUP_HOUR_S;
+  if (h_from >= h_to)
+  {
+    // 온전한 시간이 없으면 분 행만
+    bounds[0] = 0;
+    bounds[1] = 0;
+    bounds[2] = m_from;
+    bounds[3] = m_to;
+    bounds[4] = 0;
+    bounds[5] = 0;
+  }
+  else
+  {
+    const int64_t per_hour = STORAGE_ROLLUP_HOUR_S / STORAGE_ROLLUP_MINUTE_S;
+
+    bounds[0] = h_from;
+    bounds[1] = h_to;
+    bounds[2] = m_from;
+    bounds[3] = h_from * per_hour;
+    bounds[4] = h_to * per_hour;
+    bounds[5] = m_to;
+  }
+
+  start_ns = monotonic_ns();
+  if (partition_dir != NULL)
+  {
+    files = query_partitions(partition_dir, from_s, to_s, bounds, &t);
+    if (files < 0)
+    {
+      return 1;
+    }
+  }
+  else
+  {
+    if (ensure_rollups(path) < 0)
+    {
+      return 1;
+    }
+    if (sqlite3_open_v2(path, &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK)
+    {
+      fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
+      sqlite3_close(db);
+      return 1;
+    }
+    sqlite3_busy_timeout(db, 5000);
+    if (query_schemas(db, main_schema, 1, bounds, &t) < 0)
+    {
+      sqlite3_close(db);
+      return 1;
+    }
+    sqlite3_close(db);
+  }
+  elapsed_ns = monotonic_ns() - start_ns;
+
+  format_minute(from_s, from_text, sizeof(from_text));
+  format_minute(to_s, to_text, sizeof(to_text));
+  printf("구간: %s ~ %s (DB 파일 %d개, 요약 행 %lld개, %.1f us)\n",
+         from_s > 0 ? from_text : "처음", to_s < FAR_FUTURE_S ? to_text : "지금",
+         files, (long long)t.rows, elapsed_ns / 1000.0);
+
+  if (t.count == 0)
+  {
+    printf("측정 없음\n");
+  }
+  else
+  {
+    // 합과 제곱합은 0.1mm 정수라 평균/분산 계산 전까지 오차가 없음
+    double mean = (double)t.sum / t.count;
+    double var = (double)t.sum_sq / t.count - mean * mean;
+
+    printf("총 측정 횟수: %lld\n", (long long)t.count);
+    printf("평균 거리: %.2f cm (표준편차 %.2f cm)\n", mean * 0.01, sqrt(var > 0 ? var : 0) * 0.01);
+    printf("최소 거리: %.2f cm\n", t.min * 0.01);
+    printf("최대 거리: %.2f cm\n", t.max * 0.01);
+    printf("IR 트리거 횟수: %lld\n", (long long)t.ir_hits);
+  }
+
+  return 0;
+}
+
+// ========== 요약 테이블이 없는 예전 DB면 만들어 채우기 ==========
+// 요약 테이블보다 먼저 쌓인 파일은 로거와 같은 storage_create_rollups로 한 번만 채움
+// 있으면 읽기 전용으로 확인만 하고, 없을 때만 쓰기로 다시 열어 만듦
+static int ensure_rollups(const char *path)
+{
+  sqlite3 *db = NULL;
+  sqlite3_stmt *probe = NULL;
+  bool exists, compact;
+  int rc;
+
+  if (sqlite3_open_v2(path, &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
+    sqlite3_close(db);
+    return -1;
+  }
+  exists = (sqlite3_prepare_v2(db, "SELECT bucket FROM rollup_minute LIMIT 0;",
+                               -1, &probe, NULL) == SQLITE_OK);
+  sqlite3_finalize(probe);
+  compact = (sqlite3_prepare_v2(db, "SELECT ts_ns FROM samples LIMIT 0;",
+                                -1, &probe, NULL) == SQLITE_OK);
+  sqlite3_finalize(probe);
+  sqlite3_close(db);
+  if (exists)
+  {
+    return 0;
+  }
+
+  db = NULL;
+  if (sqlite3_open_v2(path, &db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
+    sqlite3_close(db);
+    return -1;
+  }
+  sqlite3_busy_timeout(db, 5000);
+  rc = storage_create_rollups(db, compact);
+  if (rc < 0)
+  {
+    fprintf(stderr, "SQL error (%s): %s\n", path, sqlite3_errmsg(db));
+    fprintf(stderr, "%s: 요약 테이블을 만들지 못함 (쓰기 권한이 있어야 함)\n", path);
+  }
+  else if (rc > 0)
+  {
+    fprintf(stderr, "%s: 요약 테이블이 없어 기존 행으로 만들어 채움\n", path);
+  }
+  sqlite3_close(db);
+  return (rc < 0) ? -1 : 0;
+}
+
+// ========== 스키마(main 또는 붙인 파티션) 묶음의 요약 행 합치기 ==========
+static int query_schemas(sqlite3 *db, const char *const *schemas, int count,
+                         const int64_t bounds[6], struct totals *t)
+{
+  char sql[8192];
+  size_t len;
+  sqlite3_stmt *stmt = NULL;
+
+  len = snprintf(sql, sizeof(sql),
+                 "SELECT SUM(count), SUM(sum), SUM(sum_sq), MIN(min), MAX(max), SUM(ir_hits), "
+                 "COUNT(*) FROM (");
+  for (int i = 0; i < count && len < sizeof(sql); i++)
+  {
+    len += snprintf(sql + len, sizeof(sql) - len,
+                    "%sSELECT count, sum, sum_sq, min, max, ir_hits FROM %s.rollup_hour "
+                    "WHERE bucket >= ?1 AND bucket < ?2 "
+                    "UNION ALL "
+                    "SELECT count, sum, sum_sq, min, max, ir_hits FROM %s.rollup_minute "
+                    "WHERE (bucket >= ?3 AND bucket < ?4) OR (bucket >= ?5 AND bucket < ?6)",
+                    i > 0 ? " UNION ALL " : "", schemas[i], schemas[i]);
+  }
+  if (len < sizeof(sql))
+  {
+    snprintf(sql + len, sizeof(sql) - len, ");");
+  }
+
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    return -1;
+  }
+  for (int i = 0; i < 6; i++)
+  {
+    sqlite3_bind_int64(stmt, i + 1, bounds[i]);
+  }
+
+  if (sqlite3_step(stmt) != SQLITE_ROW)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+    sqlite3_finalize(stmt);
+    return -1;
+  }
+
+  t->rows += sqlite3_column_int64(stmt, 6);
+  if (sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+  {
+    int64_t min = sqlite3_column_int64(stmt, 3);
+    int64_t max = sqlite3_column_int64(stmt, 4);
+
+    t->count += sqlite3_column_int64(stmt, 0);
+    t->sum += sqlite3_column_int64(stmt, 1);
+    t->sum_sq += sqlite3_column_int64(stmt, 2);
+    t->ir_hits += sqlite3_column_int64(stmt, 5);
+    if (min < t->min)
+    {
+      t->min = min;
+    }
+    if (max > t->max)
+    {
+      t->max = max;
+    }
+  }
+  sqlite3_finalize(stmt);
+  return 0;
+}
+
+// ========== 파티션 디렉터리에서 구간과 겹치는 파일만 붙여 읽기 ==========
+// 파일 i의 측정은 [시작_i, 시작_i+1) 안에 있으므로 구간 길이를 몰라도 겹침을 판단할 수 있음
+// 읽은 파일 수를 돌려줌 (실패하면 -1)
+static int query_partitions(const char *dir, int64_t from_s, int64_t to_s,
+                            const int64_t bounds[6], struct totals *t)
+{
+  struct dirent **list;
+  const char *schemas[PARTITION_MAX_ATTACH];
+  char names[PARTITION_MAX_ATTACH][8];
+  char path[PARTITION_PATH_MAX];
+  sqlite3 *db = NULL;
+  int count, attached = 0, files = 0, rc = 0;
+
+  count = partition_scan(dir, &list);
+  if (count < 0)
+  {
+    perror(dir);
+    return -1;
+  }
+
+  // 파티션은 읽기만 하므로 빈 메모리 DB에 붙임
+  if (sqlite3_open(":memory:", &db) != SQLITE_OK)
+  {
+    fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
+    sqlite3_close(db);
+    partition_free(list, count);
+    return -1;
+  }
+  sqlite3_busy_timeout(db, 5000);
+  for (int i = 0; i < PARTITION_MAX_ATTACH; i++)
+  {
+    snprintf(names[i], sizeof(names[i]), "p%d", i);
+    schemas[i] = names[i];
+  }
+
+  for (int i = 0; i < count && rc == 0; i++)
+  {
+    int64_t start_s = partition_start_s(list[i]->d_name);
+    int64_t next_s = (i + 1 < count) ? partition_start_s(list[i + 1]->d_name) : FAR_FUTURE_S;
+
+    if (start_s < to_s && next_s > from_s)
+    {
+      char *sql;
+
+      snprintf(path, sizeof(path), "%s/%s", dir, list[i]->d_name);
+      if (ensure_rollups(path) < 0)
+      {
+        rc = -1;
+        break;
+      }
+      sql = sqlite3_mprintf("ATTACH DATABASE %Q AS %s;", path, names[attached]);
+      if (sqlite3_exec(db, sql, 0, 0, NULL) != SQLITE_OK)
+      {
+        fprintf(stderr, "SQL error (%s): %s\n", path, sqlite3_errmsg(db));
+        rc = -1;
+      }
+      sqlite3_free(sql);
+      if (rc < 0)
+      {
+        break;
+      }
+      attached++;
+      files++;
+    }
+
+    // 한도만큼 붙였거나 마지막 파일이면 이 묶음을 읽고 떼어냄
+    if (attached == PARTITION_MAX_ATTACH || (i == count - 1 && attached > 0))
+    {
+      rc = query_schemas(db, schemas, attached, bounds, t);
+      for (int k = 0; k < attached; k++)
+      {
+        char sql[32];
+
+        snprintf(sql, sizeof(sql), "DETACH DATABASE p%d;", k);
+        sqlite3_exec(db, sql, 0, 0, NULL);
+      }
+      attached = 0;
+    }
+  }
+
+  sqlite3_close(db);
+  partition_free(list, count);
+  return (rc < 0) ? -1 : files;
+}
+
+// ========== "YYYY-MM-DD HH:MM" (현지 시각) → epoch 초 ==========
+static int parse_minute(const char *text, int64_t *epoch_s)
+{
+  struct tm tm;
+  const char *end;
+
+  memset(&tm, 0, sizeof(tm));
+  end = strptime(text, "%Y-%m-%d %H:%M", &tm);
+  if (end == NULL || *end != '\0')
+  {
+    fprintf(stderr, "시각 형식은 \"YYYY-MM-DD HH:MM\": %s\n", text);
+    return -1;
+  }
+  tm.tm_isdst = -1;
+  *epoch_s = mktime(&tm);
+  return 0;
+}
+
+// ========== epoch 초 → "YYYY-MM-DD HH:MM" (현지 시각) ==========
+static void format_minute(int64_t epoch_s, char *out, size_t size)
+{
+  time_t t = epoch_s;
+  struct tm tm;
+
+  localtime_r(&t, &tm);
+  strftime(out, size, "%Y-%m-%d %H:%M", &tm);
+}
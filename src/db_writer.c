@@ -0,0 +1,151 @@
+/*
+파일명: db_writer.c
+작성일: 2026-10-16
+설명: SQLite 전용 쓰기 스레드
+      커밋/체크포인트가 느리거나 다른 프로세스(make view_db 등)가 DB를 잠가도
+      측정 루프는 멈추지 않음. 링이 가득 차면 기다리지 않고 버린 수만 셈
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include "db_writer.h"
+#include "event_loop.h"
+
+static void *writer_thread(void *arg);
+
+// ========== 스레드 시작 ==========
+// st는 이미 열린 상태여야 하며, 이후 db_writer_stop 전까지 다른 곳에서 쓰지 않음
+int db_writer_start(struct db_writer *w, struct storage *st)
+{
+  pthread_attr_t attr;
+  int ret;
+
+  w->storage = st;
+  atomic_init(&w->stop, false);
+  sample_ring_init(&w->ring);
+
+  w->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (w->wake_fd < 0)
+  {
+    perror("eventfd");
+    return -1;
+  }
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, DB_WRITER_STACK_SIZE);
+  ret = pthread_create(&w->thread, &attr, writer_thread, w);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("pthread_create (db writer)");
+    close(w->wake_fd);
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 레코드 넘기기 (측정 루프) ==========
+// 할당도 잠금도 없음. 링이 가득 차면 false (버린 수는 링이 셈)
+bool db_writer_submit(struct db_writer *w, const struct sample *s)
+{
+  uint64_t one = 1;
+
+  if (!sample_ring_push(&w->ring, s))
+  {
+    return false;
+  }
+  // 논블로킹 eventfd라 카운터가 넘치지 않는 한 바로 돌아옴
+  if (write(w->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+  {
+    perror("db writer wake");
+  }
+  return true;
+}
+
+// ========== 넘쳐서 버린 레코드 수 ==========
+uint32_t db_writer_dropped(struct db_writer *w)
+{
+  return sample_ring_dropped(&w->ring);
+}
+
+// ========== 스레드 종료 ==========
+// 링에 남은 레코드를 모두 쓰고 묶음을 커밋한 뒤 끝남
+void db_writer_stop(struct db_writer *w)
+{
+  uint64_t one = 1;
+
+  atomic_store(&w->stop, true);
+  if (write(w->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+  {
+    perror("db writer wake");
+  }
+  pthread_join(w->thread, NULL);
+  close(w->wake_fd);
+}
+
+// ========== 쓰기 스레드 본체 ==========
+static void *writer_thread(void *arg)
+{
+  struct db_writer *w = arg;
+  struct storage *st = w->storage;
+  struct pollfd pfd = { w->wake_fd, POLLIN, 0 };
+  struct sample s;
+  int64_t batch_deadline_ns = 0;
+  uint64_t count;
+  int timeout_ms;
+
+  while (1)
+  {
+    // 열린 묶음이 있고 시간 제한이 있으면 그 마감까지만 대기
+    timeout_ms = -1;
+    if (st->batch_count > 0 && st->config.batch_ms > 0)
+    {
+      int64_t left_ns = batch_deadline_ns - monotonic_ns();
+      timeout_ms = (left_ns > 0) ? (int)((left_ns + 999999) / 1000000) : 0;
+    }
+
+    if (poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR)
+    {
+      perror("db writer poll");
+      break;
+    }
+    if (read(w->wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    {
+      perror("db writer read");
+    }
+
+    while (sample_ring_pop(&w->ring, &s))
+    {
+      storage_insert(st, &s);
+      // 새 묶음의 첫 행이면 시간 제한 시작
+      if (st->batch_count == 1)
+      {
+        batch_deadline_ns = monotonic_ns() + st->config.batch_ms * 1000000LL;
+      }
+    }
+
+    if (st->batch_count > 0 && st->config.batch_ms > 0 && monotonic_ns() >= batch_deadline_ns)
+    {
+      storage_flush(st);
+    }
+
+    if (atomic_load(&w->stop))
+    {
+      break;
+    }
+  }
+
+  // 종료 요청 이후 들어온 것까지 모두 쓰고 커밋
+  while (sample_ring_pop(&w->ring, &s))
+  {
+    storage_insert(st, &s);
+  }
+  storage_flush(st);
+  return NULL;
+}
@@ -0,0 +1,35 @@
+/*
+파일명: db_writer.h
+작성일: 2026-10-16
+설명: SQLite 전용 쓰기 스레드
+      측정 루프는 SPSC 링에 레코드를 넣기만 하고, sqlite3 핸들은 이 스레드만 사용
+ */
+
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "sample_ring.h"
+#include "storage.h"
+
+#define DB_WRITER_STACK_SIZE (512 * 1024)   // 쓰기 스레드 스택 (SQLite 호출 깊이 포함)
+
+// ========== 쓰기 스레드 ==========
+struct db_writer
+{
+  pthread_t thread;
+  struct storage *storage;   // 시작 후에는 이 스레드만 접근
+  struct sample_ring ring;   // 측정 루프 → 쓰기 스레드
+  int wake_fd;               // eventfd: 새 레코드 알림 (논블로킹 쓰기)
+  _Atomic bool stop;
+};
+
+int db_writer_start(struct db_writer *w, struct storage *st);
+bool db_writer_submit(struct db_writer *w, const struct sample *s);
+uint32_t db_writer_dropped(struct db_writer *w);
+void db_writer_stop(struct db_writer *w);
+
+#endif
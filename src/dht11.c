@@ -0,0 +1,367 @@
+/*
+파일명: dht11.c
+작성일: 2026-10-16
+설명: DHT11 온습도 센서 드라이버
+      시작 신호 뒤 응답 에지를 커널 이벤트 버퍼에서 한꺼번에 읽고,
+      타임스탬프 배열을 한 번 훑어 HIGH 폭으로 비트를 가름
+      (usleep(1) 반복 횟수는 스케줄러 지연에 따라 달라져 실패가 잦았음)
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include "dht11.h"
+#include "event_loop.h"
+
+static int64_t thread_cpu_ns(void);
+static int64_t event_ns(const struct gpiod_line_event *event);
+static int request_events(struct dht11 *dht);
+static int send_start(struct dht11 *dht);
+static int capture_edges(struct dht11 *dht);
+static void *reader_thread(void *arg);
+
+// ========== 초기화 ==========
+// 라인은 읽기 사이에도 에지 이벤트 입력으로 잡아 둠
+// (libgpiod v1에서 이벤트 요청은 입력 전용이라 시작 신호를 보낼 때만 잠깐 출력으로 바꿈)
+int dht11_init(struct dht11 *dht, struct gpiod_line *line)
+{
+  dht->line = line;
+  dht->event_count = 0;
+  dht->last.humidity = 0;
+  dht->last.temperature = 0;
+  dht->last.ts_ns = 0;
+  dht->reads = 0;
+  dht->ok = 0;
+  dht->short_frames = 0;
+  dht->bad_checksums = 0;
+  dht->io_errors = 0;
+  dht->cpu_total_ns = 0;
+  dht->cpu_max_ns = 0;
+  atomic_init(&dht->temp_c, 0);
+  atomic_init(&dht->temp_valid, false);
+
+  if (request_events(dht) < 0)
+  {
+    perror("DHT11 edge events unavailable");
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 해제 ==========
+void dht11_release(struct dht11 *dht)
+{
+  gpiod_line_release(dht->line);
+}
+
+// ========== 읽기 1회 ==========
+// 시작 신호(18ms LOW) → 응답 에지 수집 → 해석
+// 호출 간격은 DHT11_MIN_INTERVAL_NS 이상이어야 함 (호출하는 쪽 책임)
+int dht11_read(struct dht11 *dht, struct dht11_reading *out)
+{
+  int64_t cpu_start_ns = thread_cpu_ns();
+  int64_t cpu_ns;
+  uint8_t data[5];
+  int status;
+
+  dht->reads++;
+  dht->event_count = 0;
+
+  if (send_start(dht) < 0 || capture_edges(dht) < 0)
+  {
+    status = DHT11_IO_ERROR;
+  }
+  else
+  {
+    status = dht11_decode(dht->events, dht->event_count, data);
+  }
+
+  switch (status)
+  {
+    case DHT11_OK:
+      dht->ok++;
+      dht->last.humidity = data[0] + data[1] * 0.1;
+      dht->last.temperature = data[2] + (data[3] & 0x7F) * 0.1;
+      if (data[3] & 0x80)   // 영하 표시 비트 (신형 DHT11)
+      {
+        dht->last.temperature = -dht->last.temperature;
+      }
+      dht->last.ts_ns = monotonic_ns();
+      atomic_store_explicit(&dht->temp_c, (int)lround(dht->last.temperature),
+                            memory_order_relaxed);
+      atomic_store_explicit(&dht->temp_valid, true, memory_order_release);
+      if (out != NULL)
+      {
+        *out = dht->last;
+      }
+      break;
+    case DHT11_SHORT_FRAME:
+      dht->short_frames++;
+      break;
+    case DHT11_BAD_CHECKSUM:
+      dht->bad_checksums++;
+      break;
+    default:
+      dht->io_errors++;
+      break;
+  }
+
+  cpu_ns = thread_cpu_ns() - cpu_start_ns;
+  dht->cpu_total_ns += cpu_ns;
+  if (cpu_ns > dht->cpu_max_ns)
+  {
+    dht->cpu_max_ns = cpu_ns;
+  }
+  return status;
+}
+
+// ========== 에지 배열 해석 ==========
+// 상승 에지부터 다음 하강 에지까지가 HIGH 폭, 50us보다 길면 1
+// 마지막 40개의 HIGH 폭만 남기므로 응답 신호(80us HIGH)를 받았든
+// 이벤트 요청이 늦어 놓쳤든 같은 결과가 나옴
+int dht11_decode(const struct gpiod_line_event *events, int count, uint8_t data[5])
+{
+  int64_t rise_ns = -1;
+  uint64_t bits = 0;
+  int nbits = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    int64_t ts = event_ns(&events[i]);
+
+    if (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE)
+    {
+      rise_ns = ts;
+    }
+    else if (rise_ns >= 0)
+    {
+      bits = (bits << 1) | (ts - rise_ns > DHT11_BIT_THRESHOLD_NS);
+      nbits++;
+      rise_ns = -1;
+    }
+  }
+
+  if (nbits < DHT11_BITS)
+  {
+    return DHT11_SHORT_FRAME;
+  }
+
+  for (int i = 0; i < 5; i++)
+  {
+    data[i] = (bits >> (32 - 8 * i)) & 0xFF;
+  }
+  if (data[4] != ((data[0] + data[1] + data[2] + data[3]) & 0xFF))
+  {
+    return DHT11_BAD_CHECKSUM;
+  }
+  return DHT11_OK;
+}
+
+// ========== 성공률 / CPU 시간 통계 출력 ==========
+void dht11_print_stats(const struct dht11 *dht)
+{
+  if (dht->reads == 0)
+  {
+    return;
+  }
+
+  printf("DHT11: 읽기 %llu회, 성공 %llu회 (%.1f%%), 짧은 프레임 %llu, 체크섬 오류 %llu, I/O 오류 %llu\n",
+         (unsigned long long)dht->reads, (unsigned long long)dht->ok,
+         100.0 * dht->ok / dht->reads,
+         (unsigned long long)dht->short_frames,
+         (unsigned long long)dht->bad_checksums,
+         (unsigned long long)dht->io_errors);
+  printf("DHT11 CPU 시간: 읽기당 평균 %.1f us, 최대 %.1f us\n",
+         dht->cpu_total_ns / 1000.0 / dht->reads, dht->cpu_max_ns / 1000.0);
+}
+
+// ========== 주기 읽기 스레드 시작 ==========
+// 읽기 한 번이 약 25ms 블로킹하므로 이벤트 루프가 아닌 별도 스레드에서 돌림
+int dht11_start(struct dht11 *dht, int interval_ms)
+{
+  pthread_attr_t thread_attr;
+  int ret;
+
+  if (interval_ms <= 0)
+  {
+    interval_ms = DHT11_DEFAULT_INTERVAL_MS;
+  }
+  dht->interval_ns = interval_ms * 1000000LL;
+  if (dht->interval_ns < DHT11_MIN_INTERVAL_NS)
+  {
+    dht->interval_ns = DHT11_MIN_INTERVAL_NS;
+  }
+  dht->stop = false;
+
+  // 종료 요청을 기다리는 시각은 CLOCK_MONOTONIC 기준
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&dht->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  pthread_mutex_init(&dht->lock, NULL);
+
+  pthread_attr_init(&thread_attr);
+  pthread_attr_setstacksize(&thread_attr, DHT11_STACK_SIZE);
+  ret = pthread_create(&dht->thread, &thread_attr, reader_thread, dht);
+  pthread_attr_destroy(&thread_attr);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("pthread_create (dht11)");
+    pthread_cond_destroy(&dht->cond);
+    pthread_mutex_destroy(&dht->lock);
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 주기 읽기 스레드 종료 ==========
+// 다음 읽기를 기다리는 중이면 바로 깨어나 끝남
+void dht11_stop(struct dht11 *dht)
+{
+  pthread_mutex_lock(&dht->lock);
+  dht->stop = true;
+  pthread_cond_signal(&dht->cond);
+  pthread_mutex_unlock(&dht->lock);
+
+  pthread_join(dht->thread, NULL);
+  pthread_cond_destroy(&dht->cond);
+  pthread_mutex_destroy(&dht->lock);
+}
+
+// ========== 최근 온도 (반올림한 정수 C) ==========
+// 아직 한 번도 읽지 못했으면 fallback_c
+int dht11_cached_temp_c(struct dht11 *dht, int fallback_c)
+{
+  if (!atomic_load_explicit(&dht->temp_valid, memory_order_acquire))
+  {
+    return fallback_c;
+  }
+  return atomic_load_explicit(&dht->temp_c, memory_order_relaxed);
+}
+
+// ========== 읽기 스레드 본체 ==========
+// 읽기 시각은 절대 시각으로 예약해 읽는 데 걸린 시간만큼 밀리지 않음
+static void *reader_thread(void *arg)
+{
+  struct dht11 *dht = arg;
+  int64_t next_ns = monotonic_ns();
+
+  pthread_mutex_lock(&dht->lock);
+  while (!dht->stop)
+  {
+    struct timespec wake;
+
+    pthread_mutex_unlock(&dht->lock);
+    dht11_read(dht, NULL);
+    pthread_mutex_lock(&dht->lock);
+
+    next_ns += dht->interval_ns;
+    wake.tv_sec = next_ns / 1000000000LL;
+    wake.tv_nsec = next_ns % 1000000000LL;
+    while (!dht->stop &&
+           pthread_cond_timedwait(&dht->cond, &dht->lock, &wake) != ETIMEDOUT)
+    {
+    }
+  }
+  pthread_mutex_unlock(&dht->lock);
+  return NULL;
+}
+
+// ========== 라인을 양방향 에지 이벤트 입력으로 요청 ==========
+static int request_events(struct dht11 *dht)
+{
+  return gpiod_line_request_both_edges_events(dht->line, "dht11");
+}
+
+// ========== 시작 신호 ==========
+// 출력 LOW로 다시 요청해 18ms 유지한 뒤 곧바로 이벤트 입력으로 돌려놓음
+// 입력으로 바뀌는 순간 풀업이 라인을 올리고, 센서가 20~40us 뒤 응답함
+static int send_start(struct dht11 *dht)
+{
+  gpiod_line_release(dht->line);
+  if (gpiod_line_request_output(dht->line, "dht11", 0) < 0)
+  {
+    perror("DHT11 start signal failed");
+    request_events(dht);
+    return -1;
+  }
+  usleep(DHT11_START_LOW_US);
+  gpiod_line_release(dht->line);
+
+  if (request_events(dht) < 0)
+  {
+    perror("DHT11 edge events unavailable");
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 응답 에지 수집 ==========
+// 커널 이벤트 버퍼(16개)가 넘치지 않도록 도착하는 대로 여러 개씩 읽음
+// 첫 에지 후에는 1ms 동안 조용하면 프레임이 끝난 것으로 봄
+static int capture_edges(struct dht11 *dht)
+{
+  int64_t deadline_ns = monotonic_ns() + DHT11_FRAME_TIMEOUT_NS;
+
+  while (dht->event_count < DHT11_MAX_EDGES)
+  {
+    int64_t wait_ns = deadline_ns - monotonic_ns();
+    struct timespec timeout;
+    int ret;
+
+    if (dht->event_count > 0 && wait_ns > DHT11_IDLE_TIMEOUT_NS)
+    {
+      wait_ns = DHT11_IDLE_TIMEOUT_NS;
+    }
+    if (wait_ns <= 0)
+    {
+      break;
+    }
+    timeout.tv_sec = wait_ns / 1000000000LL;
+    timeout.tv_nsec = wait_ns % 1000000000LL;
+
+    ret = gpiod_line_event_wait(dht->line, &timeout);
+    if (ret < 0)
+    {
+      perror("DHT11 event wait failed");
+      return -1;
+    }
+    if (ret == 0)
+    {
+      break;
+    }
+
+    ret = gpiod_line_event_read_multiple(dht->line, &dht->events[dht->event_count],
+                                         DHT11_MAX_EDGES - dht->event_count);
+    if (ret < 0)
+    {
+      if (errno == EAGAIN)
+      {
+        continue;
+      }
+      perror("DHT11 event read failed");
+      return -1;
+    }
+    dht->event_count += ret;
+  }
+  return 0;
+}
+
+// ========== 스레드 CPU 시간 (ns) ==========
+static int64_t thread_cpu_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ========== 이벤트 타임스탬프 (ns) ==========
+static int64_t event_ns(const struct gpiod_line_event *event)
+{
+  return event->ts.tv_sec * 1000000000LL + event->ts.tv_nsec;
+}
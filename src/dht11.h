@@ -0,0 +1,89 @@
+/*
+파일명: dht11.h
+작성일: 2026-10-16
+설명: DHT11 온습도 센서 드라이버
+      응답 파형을 양방향 에지 이벤트 묶음으로 받아 커널 타임스탬프로
+      각 비트의 HIGH 폭을 재서 해석 (usleep(1) 횟수 세기 대신)
+ */
+
+#ifndef DHT11_H
+#define DHT11_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <gpiod.h>
+
+// ========== 타이밍 상수 ==========
+#define DHT11_START_LOW_US 18000          // 시작 신호 LOW 유지 (최소 18ms)
+#define DHT11_BIT_THRESHOLD_NS 50000LL    // HIGH 폭이 이보다 길면 1 (0: 26~28us, 1: 70us)
+#define DHT11_FRAME_TIMEOUT_NS 10000000LL // 시작 신호 후 응답 전체를 기다리는 시간
+#define DHT11_IDLE_TIMEOUT_NS 1000000LL   // 마지막 에지 후 이만큼 조용하면 프레임 끝
+#define DHT11_MIN_INTERVAL_NS 1000000000LL // 센서가 요구하는 읽기 간격 (1초 이상)
+#define DHT11_DEFAULT_INTERVAL_MS 2000    // 읽기 스레드 기본 주기
+
+// 응답 80us LOW/HIGH + 40비트 x 2에지 + 끝 에지 = 84, 여유 포함
+#define DHT11_MAX_EDGES 96
+#define DHT11_BITS 40
+#define DHT11_STACK_SIZE (64 * 1024)     // 읽기 스레드 스택
+
+// ========== 읽기 결과 코드 ==========
+enum dht11_status
+{
+  DHT11_OK = 0,
+  DHT11_SHORT_FRAME = -1,   // 40비트를 다 못 받음 (에지 유실 또는 무응답)
+  DHT11_BAD_CHECKSUM = -2,  // 체크섬 불일치
+  DHT11_IO_ERROR = -3       // 라인 요청/이벤트 읽기 실패
+};
+
+// ========== 측정값 ==========
+struct dht11_reading
+{
+  double humidity;          // %
+  double temperature;       // C
+  int64_t ts_ns;            // 읽은 시각 (CLOCK_MONOTONIC)
+};
+
+// ========== 센서 상태 ==========
+struct dht11
+{
+  struct gpiod_line *line;  // 읽기 사이에도 에지 이벤트 입력으로 요청해 둠
+  struct gpiod_line_event events[DHT11_MAX_EDGES];
+  int event_count;
+  struct dht11_reading last;  // 마지막 성공 값 (last.ts_ns == 0이면 아직 없음)
+
+  // 주기 읽기 스레드 (dht11_start 이후 센서는 이 스레드만 읽음)
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;      // 다음 읽기까지 기다리다 종료 요청에 바로 깸
+  bool stop;                // lock으로 보호
+  int64_t interval_ns;
+  _Atomic int temp_c;       // 마지막 성공 온도 (반올림한 정수 C)
+  _Atomic bool temp_valid;  // 한 번이라도 읽었는지
+
+  // 통계
+  uint64_t reads;
+  uint64_t ok;
+  uint64_t short_frames;
+  uint64_t bad_checksums;
+  uint64_t io_errors;
+  int64_t cpu_total_ns;     // 읽기 1회에 쓴 CPU 시간 (CLOCK_THREAD_CPUTIME_ID)
+  int64_t cpu_max_ns;
+};
+
+int dht11_init(struct dht11 *dht, struct gpiod_line *line);
+void dht11_release(struct dht11 *dht);
+int dht11_read(struct dht11 *dht, struct dht11_reading *out);
+void dht11_print_stats(const struct dht11 *dht);
+
+// ========== 주기 읽기 스레드 ==========
+// 다른 스레드는 dht11_cached_temp_c로 최근 온도만 가져감 (잠금, 시스템 콜 없음)
+int dht11_start(struct dht11 *dht, int interval_ms);
+void dht11_stop(struct dht11 *dht);
+int dht11_cached_temp_c(struct dht11 *dht, int fallback_c);
+
+// 에지 배열을 한 번 훑어 5바이트 프레임으로 해석 (하드웨어 없이 테스트 가능)
+int dht11_decode(const struct gpiod_line_event *events, int count, uint8_t data[5]);
+
+#endif
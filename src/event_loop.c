@@ -0,0 +1,165 @@
+/*
+파일명: event_loop.c
+작성일: 2026-10-16
+설명: epoll 기반 단일 이벤트 루프
+      프로그램이 잠드는 곳은 event_loop_run()의 epoll_wait 한 곳뿐
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include "event_loop.h"
+
+// ========== 초기화 ==========
+int event_loop_init(struct event_loop *loop)
+{
+  loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  loop->running = false;
+  return (loop->epoll_fd < 0) ? -1 : 0;
+}
+
+// ========== 종료 ==========
+void event_loop_close(struct event_loop *loop)
+{
+  if (loop->epoll_fd >= 0)
+  {
+    close(loop->epoll_fd);
+    loop->epoll_fd = -1;
+  }
+}
+
+// ========== 이벤트 소스 등록 (읽기 가능 이벤트) ==========
+int event_loop_add(struct event_loop *loop, struct event_source *src,
+                   int fd, event_handler handler, void *arg)
+{
+  struct epoll_event ev;
+
+  src->fd = fd;
+  src->handler = handler;
+  src->arg = arg;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = src;
+  return epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+// ========== 이벤트 소스 제거 ==========
+int event_loop_remove(struct event_loop *loop, struct event_source *src)
+{
+  return epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+}
+
+// ========== 루프 실행 ==========
+// event_loop_stop()이 호출될 때까지 이벤트를 받아 핸들러로 전달
+int event_loop_run(struct event_loop *loop)
+{
+  struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+  loop->running = true;
+  while (loop->running)
+  {
+    int n = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_MAX_EVENTS, -1);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      perror("epoll_wait");
+      return -1;
+    }
+
+    for (int i = 0; i < n && loop->running; i++)
+    {
+      struct event_source *src = events[i].data.ptr;
+      src->handler(src, events[i].events);
+    }
+  }
+
+  return 0;
+}
+
+// ========== 루프 정지 요청 ==========
+void event_loop_stop(struct event_loop *loop)
+{
+  loop->running = false;
+}
+
+// ========== timerfd 생성 ==========
+int timer_create_fd(void)
+{
+  return timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+}
+
+// ========== 절대 시각에 한 번 만료 ==========
+int timer_arm_at(int fd, int64_t deadline_ns)
+{
+  struct itimerspec its;
+
+  memset(&its, 0, sizeof(its));
+  // it_value가 0이면 타이머가 꺼지므로 지난 시각은 1ns로 보정
+  if (deadline_ns <= 0)
+  {
+    deadline_ns = 1;
+  }
+  its.it_value.tv_sec = deadline_ns / 1000000000LL;
+  its.it_value.tv_nsec = deadline_ns % 1000000000LL;
+  return timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// ========== 타이머 끄기 ==========
+int timer_disarm(int fd)
+{
+  struct itimerspec its;
+
+  memset(&its, 0, sizeof(its));
+  return timerfd_settime(fd, 0, &its, NULL);
+}
+
+// ========== 만료 횟수 읽기 ==========
+uint64_t timer_consume(int fd)
+{
+  uint64_t expirations = 0;
+
+  if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+  {
+    return 0;
+  }
+  return expirations;
+}
+
+// ========== signalfd 생성 ==========
+int signal_create_fd(const int *signals, int count)
+{
+  sigset_t mask;
+
+  sigemptyset(&mask);
+  for (int i = 0; i < count; i++)
+  {
+    sigaddset(&mask, signals[i]);
+  }
+
+  // 시그널을 막아야 핸들러 대신 signalfd로 전달됨
+  if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0)
+  {
+    return -1;
+  }
+  return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+// ========== 받은 시그널 번호 읽기 ==========
+int signal_consume(int fd)
+{
+  struct signalfd_siginfo info;
+
+  if (read(fd, &info, sizeof(info)) != sizeof(info))
+  {
+    return -1;
+  }
+  return (int)info.ssi_signo;
+}
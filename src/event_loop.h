@@ -0,0 +1,66 @@
+/*
+파일명: event_loop.h
+작성일: 2026-10-16
+설명: epoll 기반 단일 이벤트 루프
+      GPIO 이벤트 fd, timerfd, signalfd를 하나의 epoll_wait로 기다림
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+
+#define EVENT_LOOP_MAX_EVENTS 16   // epoll_wait 한 번에 처리하는 최대 이벤트 수
+
+struct event_source;
+typedef void (*event_handler)(struct event_source *src, uint32_t events);
+
+// ========== 이벤트 소스 ==========
+// 호출하는 쪽이 소유 (보통 다른 구조체 안에 포함), 루프는 포인터만 보관
+struct event_source
+{
+  int fd;
+  event_handler handler;
+  void *arg;
+};
+
+// ========== 이벤트 루프 ==========
+struct event_loop
+{
+  int epoll_fd;
+  bool running;
+};
+
+int event_loop_init(struct event_loop *loop);
+void event_loop_close(struct event_loop *loop);
+int event_loop_add(struct event_loop *loop, struct event_source *src,
+                   int fd, event_handler handler, void *arg);
+int event_loop_remove(struct event_loop *loop, struct event_source *src);
+int event_loop_run(struct event_loop *loop);
+void event_loop_stop(struct event_loop *loop);
+
+// ========== 단조 시계 (ns) ==========
+// timerfd 마감 시각과 같은 CLOCK_MONOTONIC 기준 (모든 모듈과 DB 도구가 공유)
+static inline int64_t monotonic_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ========== timerfd 도우미 (CLOCK_MONOTONIC, ns) ==========
+int timer_create_fd(void);
+int timer_arm_at(int fd, int64_t deadline_ns);
+int timer_disarm(int fd);
+uint64_t timer_consume(int fd);
+
+// ========== signalfd 도우미 ==========
+// 지정한 시그널을 막고(sigprocmask) 그 시그널을 읽을 수 있는 fd를 돌려줌
+int signal_create_fd(const int *signals, int count);
+int signal_consume(int fd);
+
+#endif
@@ -0,0 +1,216 @@
+/*
+파일명: i2c_bus.c
+작성일: 2026-10-16
+설명: /dev/i2c-N 공유 버스 관리자
+      전송 하나(메시지 여러 개)를 ioctl(I2C_RDWR) 한 번으로 보내고
+      반복 START로 이어지므로 레지스터 쓰기 + 읽기 사이에 다른 장치가 끼지 않음
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include "i2c_bus.h"
+#include "event_loop.h"
+
+static void bus_acquire(struct i2c_dev *dev);
+static void bus_release(struct i2c_dev *dev);
+
+// ========== 버스 열기 ==========
+int i2c_bus_open(struct i2c_bus *bus, const char *path)
+{
+  memset(bus, 0, sizeof(*bus));
+
+  bus->fd = open(path, O_RDWR | O_CLOEXEC);
+  if (bus->fd < 0)
+  {
+    perror("Failed to open I2C device");
+    return -1;
+  }
+
+  pthread_mutex_init(&bus->lock, NULL);
+  pthread_cond_init(&bus->cond, NULL);
+  bus->opened_ns = monotonic_ns();
+  return 0;
+}
+
+// ========== 버스 닫기 ==========
+// 모든 장치의 사용이 끝난 뒤에 부름
+void i2c_bus_close(struct i2c_bus *bus)
+{
+  if (bus->fd < 0)
+  {
+    return;
+  }
+
+  close(bus->fd);
+  bus->fd = -1;
+  pthread_cond_destroy(&bus->cond);
+  pthread_mutex_destroy(&bus->lock);
+}
+
+// ========== 장치 등록 ==========
+int i2c_dev_init(struct i2c_dev *dev, struct i2c_bus *bus, uint16_t addr,
+                 int priority, const char *name)
+{
+  memset(dev, 0, sizeof(*dev));
+  dev->bus = bus;
+  dev->addr = addr;
+  dev->priority = (priority >= 0 && priority < I2C_PRIO_COUNT) ?
+                  priority : I2C_PRIO_COUNT - 1;
+  dev->name = name;
+
+  pthread_mutex_lock(&bus->lock);
+  if (bus->dev_count < I2C_BUS_MAX_DEVS)
+  {
+    bus->devs[bus->dev_count++] = dev;
+  }
+  pthread_mutex_unlock(&bus->lock);
+  return 0;
+}
+
+// ========== 전송 (I2C_RDWR) ==========
+// msgs[].addr은 장치 주소로 채움. 메시지 사이는 반복 START, 끝에 STOP 한 번
+int i2c_dev_transfer(struct i2c_dev *dev, struct i2c_msg *msgs, int count)
+{
+  struct i2c_rdwr_ioctl_data data;
+  int64_t start_ns;
+  int ret;
+
+  for (int i = 0; i < count; i++)
+  {
+    msgs[i].addr = dev->addr;
+  }
+  data.msgs = msgs;
+  data.nmsgs = count;
+
+  bus_acquire(dev);
+  start_ns = monotonic_ns();
+  ret = ioctl(dev->bus->fd, I2C_RDWR, &data);
+  dev->busy_ns += monotonic_ns() - start_ns;
+  dev->transfers++;
+  if (ret < 0)
+  {
+    dev->errors++;
+  }
+  else
+  {
+    for (int i = 0; i < count; i++)
+    {
+      dev->bytes += msgs[i].len;
+    }
+  }
+  bus_release(dev);
+
+  return (ret < 0) ? -1 : 0;
+}
+
+// ========== 쓰기만 하는 전송 ==========
+int i2c_dev_write(struct i2c_dev *dev, const uint8_t *buf, int len)
+{
+  struct i2c_msg msg;
+
+  msg.flags = 0;
+  msg.len = len;
+  msg.buf = (uint8_t *)buf;   // 쓰기 메시지는 커널이 읽기만 함
+  return i2c_dev_transfer(dev, &msg, 1);
+}
+
+// ========== 쓰기 후 읽기 (레지스터 읽기 등) ==========
+// 두 메시지가 반복 START로 이어지는 한 트랜잭션
+int i2c_dev_write_read(struct i2c_dev *dev, const uint8_t *wbuf, int wlen,
+                       uint8_t *rbuf, int rlen)
+{
+  struct i2c_msg msgs[2];
+
+  msgs[0].flags = 0;
+  msgs[0].len = wlen;
+  msgs[0].buf = (uint8_t *)wbuf;
+  msgs[1].flags = I2C_M_RD;
+  msgs[1].len = rlen;
+  msgs[1].buf = rbuf;
+  return i2c_dev_transfer(dev, msgs, 2);
+}
+
+// ========== 장치별 점유율 / 대기 통계 출력 ==========
+void i2c_bus_print_stats(const struct i2c_bus *bus)
+{
+  double elapsed_ns = (double)(monotonic_ns() - bus->opened_ns);
+
+  for (int i = 0; i < bus->dev_count; i++)
+  {
+    const struct i2c_dev *dev = bus->devs[i];
+
+    if (dev->transfers == 0)
+    {
+      continue;
+    }
+    printf("I2C 0x%02x (%s): 전송 %llu회 (실패 %llu회), %llu 바이트, "
+           "버스 점유 %.2f%%, 대기 평균 %.1f us / 최대 %.1f us\n",
+           dev->addr, dev->name,
+           (unsigned long long)dev->transfers, (unsigned long long)dev->errors,
+           (unsigned long long)dev->bytes, 100.0 * dev->busy_ns / elapsed_ns,
+           dev->queue_total_ns / 1000.0 / dev->transfers,
+           dev->queue_max_ns / 1000.0);
+  }
+}
+
+// ========== 버스 획득 ==========
+// 번호표를 받고, 버스가 비었으며 내 차례이고 더 높은 우선순위 대기가 없을 때 진행
+static void bus_acquire(struct i2c_dev *dev)
+{
+  struct i2c_bus *bus = dev->bus;
+  int prio = dev->priority;
+  int64_t request_ns = monotonic_ns();
+  int64_t waited_ns;
+  uint32_t ticket;
+
+  pthread_mutex_lock(&bus->lock);
+  ticket = bus->next_ticket[prio]++;
+
+  while (1)
+  {
+    bool higher_waiting = false;
+
+    for (int p = 0; p < prio; p++)
+    {
+      if (bus->next_ticket[p] != bus->serving[p])
+      {
+        higher_waiting = true;
+        break;
+      }
+    }
+    if (!bus->in_use && bus->serving[prio] == ticket && !higher_waiting)
+    {
+      break;
+    }
+    pthread_cond_wait(&bus->cond, &bus->lock);
+  }
+
+  bus->in_use = true;
+  bus->serving[prio]++;
+
+  waited_ns = monotonic_ns() - request_ns;
+  dev->queue_total_ns += waited_ns;
+  if (waited_ns > dev->queue_max_ns)
+  {
+    dev->queue_max_ns = waited_ns;
+  }
+  // 전송 중에는 잠금을 풀어 다른 장치가 줄을 설 수 있게 함
+  pthread_mutex_unlock(&bus->lock);
+}
+
+// ========== 버스 반납 ==========
+static void bus_release(struct i2c_dev *dev)
+{
+  struct i2c_bus *bus = dev->bus;
+
+  pthread_mutex_lock(&bus->lock);
+  bus->in_use = false;
+  pthread_cond_broadcast(&bus->cond);
+  pthread_mutex_unlock(&bus->lock);
+}
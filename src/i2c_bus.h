@@ -0,0 +1,75 @@
+/*
+파일명: i2c_bus.h
+작성일: 2026-10-16
+설명: /dev/i2c-N 공유 버스 관리자
+      어댑터 fd 하나를 여러 장치(LCD, MPU6050)가 같이 쓰고
+      전송은 I2C_RDWR 메시지로 보내므로 I2C_SLAVE 주소 전환이 필요 없음
+      버스를 기다리는 전송은 우선순위 순서, 같은 우선순위 안에서는 도착 순서
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <linux/i2c.h>
+
+#define I2C_BUS_MAX_DEVS 4    // 통계를 낼 장치 수 상한
+
+// ========== 전송 우선순위 (작을수록 먼저) ==========
+enum i2c_priority
+{
+  I2C_PRIO_SENSOR = 0,    // IMU 등 샘플을 놓치면 안 되는 읽기
+  I2C_PRIO_DISPLAY,       // LCD 같은 화면 갱신
+  I2C_PRIO_COUNT
+};
+
+struct i2c_dev;
+
+// ========== 버스 ==========
+struct i2c_bus
+{
+  int fd;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  bool in_use;                                // 지금 전송 중인 장치가 있음
+
+  // 우선순위별 번호표: next_ticket - serving = 기다리는 전송 수
+  uint32_t next_ticket[I2C_PRIO_COUNT];
+  uint32_t serving[I2C_PRIO_COUNT];
+
+  int64_t opened_ns;
+  struct i2c_dev *devs[I2C_BUS_MAX_DEVS];
+  int dev_count;
+};
+
+// ========== 버스 위의 장치 ==========
+// 통계는 버스를 점유한 동안에만 갱신 (한 번에 한 장치만 씀)
+struct i2c_dev
+{
+  struct i2c_bus *bus;
+  uint16_t addr;
+  int priority;             // enum i2c_priority
+  const char *name;
+
+  uint64_t transfers;
+  uint64_t errors;
+  uint64_t bytes;
+  int64_t busy_ns;          // 버스를 점유한 시간 합 (ioctl 구간)
+  int64_t queue_total_ns;   // 요청 → 버스 획득 대기 시간 합
+  int64_t queue_max_ns;
+};
+
+int i2c_bus_open(struct i2c_bus *bus, const char *path);
+void i2c_bus_close(struct i2c_bus *bus);
+void i2c_bus_print_stats(const struct i2c_bus *bus);
+
+int i2c_dev_init(struct i2c_dev *dev, struct i2c_bus *bus, uint16_t addr,
+                 int priority, const char *name);
+int i2c_dev_transfer(struct i2c_dev *dev, struct i2c_msg *msgs, int count);
+int i2c_dev_write(struct i2c_dev *dev, const uint8_t *buf, int len);
+int i2c_dev_write_read(struct i2c_dev *dev, const uint8_t *wbuf, int wlen,
+                       uint8_t *rbuf, int rlen);
+
+#endif
@@ -0,0 +1,311 @@
+/*
+파일명: imu_acquire.c
+작성일: 2026-10-16
+설명: MPU6050 수집 스레드
+      절대 시각으로 깨어나 FIFO를 버스트로 읽으므로 샘플 주기와 무관하게
+      I2C 트랜잭션은 간격마다 3번 (INT_STATUS, FIFO 개수, FIFO 내용)
+      인터럽트 모드는 INT 핀 에지를 기다렸다가 워터마크만큼 쌓이면 읽음
+      (MPU6050에는 FIFO 워터마크 인터럽트가 없어 data-ready 에지 수로 대신함)
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include "imu_acquire.h"
+#include "event_loop.h"
+
+#define EDGE_READ_MAX 16    // 한 번에 읽는 에지 이벤트 최대 개수
+
+static void *imu_timer_thread(void *arg);
+static void *imu_irq_thread(void *arg);
+static void drain_fifo(struct imu_acquire *acq);
+static void stamp_batch(struct imu_acquire *acq, int64_t read_ns);
+static void sleep_until(int64_t abs_ns);
+
+// ========== 스레드 시작 ==========
+// imu는 mpu6050_init으로 설정된 상태여야 함
+// int_line이 있으면 이미 상승 에지 이벤트로 요청된 INT 핀 (data-ready 인터럽트)
+int imu_acquire_start(struct imu_acquire *acq, struct mpu6050 *imu, int drain_ms,
+                      struct gpiod_line *int_line, imu_batch_handler handler, void *arg)
+{
+  pthread_attr_t attr;
+  int ret;
+
+  if (drain_ms <= 0)
+  {
+    drain_ms = IMU_DEFAULT_DRAIN_MS;
+  }
+  acq->imu = imu;
+  acq->int_line = int_line;
+  acq->drain_ns = drain_ms * 1000000LL;
+  acq->handler = handler;
+  acq->arg = arg;
+  atomic_init(&acq->stop, false);
+  acq->batch.count = 0;
+  acq->batch.period_ns = 1000000000LL / imu->rate_hz;
+  acq->edge_head = 0;
+  acq->edge_count = 0;
+  acq->edge_debt = 0;
+  acq->stamped_ns = 0;
+  acq->samples = 0;
+  acq->drains = 0;
+  acq->read_errors = 0;
+  acq->edges = 0;
+  acq->wakeups = 0;
+  acq->untimed = 0;
+
+  // 드레인 간격만큼의 샘플마다 읽되 커널 이벤트 버퍼(16개)가 넘치지 않게
+  acq->watermark = (int)(imu->rate_hz * (int64_t)drain_ms / 1000);
+  if (acq->watermark < 1)
+  {
+    acq->watermark = 1;
+  }
+  if (acq->watermark > IMU_EDGE_WATERMARK_MAX)
+  {
+    acq->watermark = IMU_EDGE_WATERMARK_MAX;
+  }
+
+  if (int_line != NULL && mpu6050_enable_data_ready(imu) < 0)
+  {
+    perror("MPU6050 interrupt setup failed");
+    return -1;
+  }
+
+  acq->started_ns = monotonic_ns();
+  acq->stopped_ns = acq->started_ns;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, IMU_STACK_SIZE);
+  ret = pthread_create(&acq->thread, &attr,
+                       (int_line != NULL) ? imu_irq_thread : imu_timer_thread, acq);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("pthread_create (imu)");
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 스레드 종료 ==========
+void imu_acquire_stop(struct imu_acquire *acq)
+{
+  atomic_store(&acq->stop, true);
+  pthread_join(acq->thread, NULL);
+}
+
+// ========== 수집 통계 출력 ==========
+void imu_acquire_print_stats(const struct imu_acquire *acq)
+{
+  double elapsed_s = (acq->stopped_ns - acq->started_ns) / 1e9;
+
+  if (acq->drains == 0 || elapsed_s <= 0)
+  {
+    return;
+  }
+
+  printf("IMU: %llu 샘플, %.1f samples/s (설정 %d Hz), FIFO 읽기 %llu회 "
+         "(평균 %.1f 프레임), FIFO 넘침 %llu회, I2C 에러 %llu회\n",
+         (unsigned long long)acq->samples, acq->samples / elapsed_s,
+         acq->imu->rate_hz, (unsigned long long)acq->drains,
+         (double)acq->samples / acq->drains,
+         (unsigned long long)acq->imu->overflows,
+         (unsigned long long)acq->read_errors);
+
+  if (acq->int_line != NULL)
+  {
+    printf("IMU 인터럽트: 에지 %llu회, 깨어남 %llu회 (%.1f회/s), "
+           "에지보다 먼저 읽혀 시각을 추정한 샘플 %llu개\n",
+           (unsigned long long)acq->edges, (unsigned long long)acq->wakeups,
+           acq->wakeups / elapsed_s, (unsigned long long)acq->untimed);
+  }
+}
+
+// ========== 타이머 모드 ==========
+static void *imu_timer_thread(void *arg)
+{
+  struct imu_acquire *acq = arg;
+  int64_t next_ns = monotonic_ns();
+
+  while (!atomic_load(&acq->stop))
+  {
+    next_ns += acq->drain_ns;
+    sleep_until(next_ns);
+    drain_fifo(acq);
+  }
+
+  acq->stopped_ns = monotonic_ns();
+  return NULL;
+}
+
+// ========== 인터럽트 모드 ==========
+// 에지마다 깨지 않도록, 워터마크까지 남은 샘플 수만큼 자고 쌓인 에지를 한 번에 읽음
+static void *imu_irq_thread(void *arg)
+{
+  struct imu_acquire *acq = arg;
+  struct gpiod_line_event events[EDGE_READ_MAX];
+  struct timespec timeout = { 0, 100000000L };   // 종료 확인용 100ms
+  int64_t period_ns = acq->batch.period_ns;
+  int ret, count;
+
+  while (!atomic_load(&acq->stop))
+  {
+    ret = gpiod_line_event_wait(acq->int_line, &timeout);
+    if (ret < 0)
+    {
+      perror("Error waiting for IMU interrupt");
+      break;
+    }
+    if (ret == 0)
+    {
+      continue;
+    }
+    acq->wakeups++;
+
+    count = gpiod_line_event_read_multiple(acq->int_line, events, EDGE_READ_MAX);
+    if (count < 0)
+    {
+      perror("Error reading IMU interrupt");
+      break;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+      int64_t ts = events[i].ts.tv_sec * 1000000000LL + events[i].ts.tv_nsec;
+
+      // 에지를 읽기 전에 FIFO에서 먼저 꺼내 시각을 추정해 둔 샘플의 에지는 버림
+      if (acq->edge_debt > 0)
+      {
+        if (ts <= acq->stamped_ns + period_ns / 2)
+        {
+          acq->edge_debt--;
+          continue;
+        }
+        acq->edge_debt = 0;   // 그 에지들은 커널 버퍼에서 사라진 것
+      }
+
+      // 가득 차면 가장 오래된 것을 버림 (그 샘플은 시각 추정)
+      if (acq->edge_count == IMU_EDGE_QUEUE)
+      {
+        acq->edge_head = (acq->edge_head + 1) % IMU_EDGE_QUEUE;
+        acq->edge_count--;
+      }
+      acq->edge_ts[(acq->edge_head + acq->edge_count) % IMU_EDGE_QUEUE] = ts;
+      acq->edge_count++;
+    }
+    acq->edges += count;
+
+    if ((int)acq->edge_count >= acq->watermark)
+    {
+      drain_fifo(acq);
+    }
+    else if (count > 0)
+    {
+      // 마지막 에지 기준으로 워터마크 직전 샘플까지 기다림
+      int64_t last_ns = acq->edge_ts[(acq->edge_head + acq->edge_count - 1) % IMU_EDGE_QUEUE];
+      sleep_until(last_ns + (acq->watermark - (int)acq->edge_count) * period_ns - period_ns / 2);
+    }
+  }
+
+  acq->stopped_ns = monotonic_ns();
+  return NULL;
+}
+
+// ========== FIFO 비우기 ==========
+// 한 번에 다 못 읽으면(묶음 크기 초과) 바로 이어서 읽음
+static void drain_fifo(struct imu_acquire *acq)
+{
+  struct imu_batch *batch = &acq->batch;
+  uint64_t overflows = acq->imu->overflows;
+  int frames;
+
+  do
+  {
+    frames = mpu6050_fifo_read(acq->imu, batch->samples, IMU_BATCH_MAX);
+    if (frames < 0)
+    {
+      acq->read_errors++;
+      return;
+    }
+    acq->drains++;
+
+    // 넘침으로 FIFO가 리셋되면 그 전 에지들은 버려진 샘플의 것
+    if (acq->imu->overflows != overflows)
+    {
+      acq->edge_count = 0;
+      acq->edge_debt = 0;
+      return;
+    }
+    if (frames == 0)
+    {
+      return;
+    }
+
+    batch->count = frames;
+    stamp_batch(acq, monotonic_ns());
+    acq->samples += frames;
+    if (acq->handler != NULL)
+    {
+      acq->handler(batch, acq->arg);
+    }
+  } while (frames == IMU_BATCH_MAX);
+}
+
+// ========== 샘플 시각 붙이기 ==========
+// FIFO의 프레임 순서 = 에지 순서이므로 오래된 에지부터 짝지음
+// 에지가 모자라면 아직 에지를 읽지 못한 최신 샘플이므로 마지막 에지에서
+// 주기만큼씩 더해 추정하고, 나중에 도착하는 그 에지들은 버리도록 표시
+static void stamp_batch(struct imu_acquire *acq, int64_t read_ns)
+{
+  struct imu_batch *batch = &acq->batch;
+  int frames = batch->count;
+  int matched = 0;
+
+  if (acq->int_line != NULL)
+  {
+    matched = ((int)acq->edge_count < frames) ? (int)acq->edge_count : frames;
+  }
+
+  for (int i = 0; i < matched; i++)
+  {
+    batch->ts_ns[i] = acq->edge_ts[acq->edge_head];
+    acq->edge_head = (acq->edge_head + 1) % IMU_EDGE_QUEUE;
+  }
+  acq->edge_count -= matched;
+
+  if (matched > 0)
+  {
+    for (int i = matched; i < frames; i++)
+    {
+      batch->ts_ns[i] = batch->ts_ns[matched - 1] + (int64_t)(i - matched + 1) * batch->period_ns;
+    }
+  }
+  else
+  {
+    // 타이머 모드(또는 에지가 하나도 없음): 마지막 샘플을 읽은 시각으로 봄
+    for (int i = 0; i < frames; i++)
+    {
+      batch->ts_ns[i] = read_ns - (int64_t)(frames - 1 - i) * batch->period_ns;
+    }
+  }
+
+  if (acq->int_line != NULL)
+  {
+    acq->untimed += frames - matched;
+    acq->edge_debt += frames - matched;
+    acq->stamped_ns = batch->ts_ns[frames - 1];
+  }
+}
+
+// ========== 절대 시각까지 잠 ==========
+static void sleep_until(int64_t abs_ns)
+{
+  struct timespec ts;
+
+  ts.tv_sec = abs_ns / 1000000000LL;
+  ts.tv_nsec = abs_ns % 1000000000LL;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+  {
+  }
+}
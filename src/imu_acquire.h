@@ -0,0 +1,75 @@
+/*
+파일명: imu_acquire.h
+작성일: 2026-10-16
+설명: MPU6050 수집 스레드
+      일정 간격으로 FIFO를 비워 샘플 묶음(batch) 단위로 처리 함수에 넘김
+      INT 핀을 GPIO 에지 이벤트로 받으면 data-ready 인터럽트마다의
+      커널 타임스탬프를 샘플 시각으로 씀 (타이머 폴링 대신)
+ */
+
+#ifndef IMU_ACQUIRE_H
+#define IMU_ACQUIRE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <gpiod.h>
+#include "mpu6050.h"
+
+#define IMU_BATCH_MAX 80           // FIFO 한 번 비울 때 최대 프레임 수
+#define IMU_DEFAULT_DRAIN_MS 20    // FIFO 비우는 간격 (1kHz면 약 20프레임, 넘침까지 85ms)
+#define IMU_EDGE_QUEUE 128         // 아직 FIFO에서 안 읽은 샘플의 에지 시각 (2의 거듭제곱)
+#define IMU_EDGE_WATERMARK_MAX 12  // 이만큼 에지가 쌓이면 FIFO 읽기 (커널 이벤트 버퍼 16개 미만)
+#define IMU_STACK_SIZE (128 * 1024)  // 수집 스레드 스택
+
+// ========== 샘플 묶음 ==========
+// 인터럽트 모드: 샘플마다 data-ready 에지의 커널 타임스탬프
+// 타이머 모드: FIFO를 읽은 시각에서 샘플 주기만큼씩 거슬러 올라가 추정
+struct imu_batch
+{
+  int count;
+  int64_t period_ns;                 // 샘플 간격
+  int64_t ts_ns[IMU_BATCH_MAX];      // 샘플 시각 (CLOCK_MONOTONIC)
+  struct imu_raw samples[IMU_BATCH_MAX];
+};
+
+typedef void (*imu_batch_handler)(const struct imu_batch *batch, void *arg);
+
+// ========== 수집 스레드 ==========
+struct imu_acquire
+{
+  pthread_t thread;
+  struct mpu6050 *imu;
+  struct gpiod_line *int_line; // NULL이면 타이머 모드
+  int64_t drain_ns;
+  int watermark;               // 인터럽트 모드에서 FIFO를 읽는 에지 수
+  imu_batch_handler handler;   // 수집 스레드에서 묶음마다 호출
+  void *arg;
+  _Atomic bool stop;
+  struct imu_batch batch;
+
+  // 읽지 않은 샘플의 에지 시각 (수집 스레드만 사용)
+  int64_t edge_ts[IMU_EDGE_QUEUE];
+  uint32_t edge_head;
+  uint32_t edge_count;
+  uint32_t edge_debt;          // 에지보다 먼저 읽어 시각을 추정한 샘플 수
+  int64_t stamped_ns;          // 마지막으로 시각을 붙인 샘플의 시각
+
+  // 통계 (수집 스레드만 씀, 종료 후 읽기)
+  uint64_t samples;
+  uint64_t drains;
+  uint64_t read_errors;
+  uint64_t edges;              // 받은 data-ready 인터럽트 수
+  uint64_t wakeups;            // 인터럽트 대기에서 깨어난 횟수
+  uint64_t untimed;            // 에지보다 먼저 읽혀 시각을 추정한 샘플 수
+  int64_t started_ns;
+  int64_t stopped_ns;
+};
+
+int imu_acquire_start(struct imu_acquire *acq, struct mpu6050 *imu, int drain_ms,
+                      struct gpiod_line *int_line, imu_batch_handler handler, void *arg);
+void imu_acquire_stop(struct imu_acquire *acq);
+void imu_acquire_print_stats(const struct imu_acquire *acq);
+
+#endif
@@ -0,0 +1,64 @@
+/*
+파일명: imu_fusion.h
+작성일: 2026-10-16
+설명: IMU 자세 추정 (고정소수점 상보 필터)
+      샘플 묶음을 구조체 배열(SoA)로 풀어 보정(오프셋, 스케일)과 단위 변환을
+      NEON/SSE4.1 벡터 커널로 처리하고, 중력 벡터 상보 필터로 roll/pitch 추정
+ */
+
+#ifndef IMU_FUSION_H
+#define IMU_FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "imu_acquire.h"
+
+#define IMU_FUSION_Q 28                 // 중력 벡터, 각 증분 고정소수점 (1.0 = 2^28)
+#define IMU_FUSION_DEFAULT_BETA 0.02    // 한 샘플마다 가속도 쪽으로 당기는 비율
+#define IMU_FUSION_CALIB_MS 500         // 시작 후 자이로 바이어스를 재는 시간 (정지 상태)
+
+// ========== 보정값 ==========
+struct imu_calib
+{
+  int16_t accel_offset[3];   // 원시 LSB
+  int16_t gyro_offset[3];
+  int32_t accel_scale[3];    // Q14 (16384 = 1.0)
+};
+
+// ========== 묶음 SoA 작업 공간 ==========
+// 벡터 커널이 4개씩 읽으므로 16바이트 정렬, 길이는 4의 배수로 올림
+struct imu_soa
+{
+  int count;
+  _Alignas(16) int16_t raw[6][IMU_BATCH_MAX + 4];    // ax, ay, az, gx, gy, gz
+  _Alignas(16) int32_t accel[3][IMU_BATCH_MAX + 4];  // Q28 g
+  _Alignas(16) int32_t dtheta[3][IMU_BATCH_MAX + 4]; // Q28 rad / 샘플
+};
+
+// ========== 필터 상태 ==========
+struct imu_fusion
+{
+  struct imu_calib calib;
+  int32_t gyro_k;            // 원시 자이로 LSB → Q28 rad/샘플 (소수 gyro_shift 비트)
+  int gyro_shift;
+  int32_t beta_q16;          // 상보 필터 가중치 (Q16)
+  int32_t g[3];              // 몸체 좌표계의 중력 방향 (Q28)
+  bool vector;               // 벡터 커널 사용 여부
+
+  // 정지 상태에서 자이로 바이어스와 초기 중력 방향 측정
+  int calib_target;
+  int calib_count;
+  int64_t calib_sum[6];
+  bool ready;
+
+  struct imu_soa soa;
+  uint64_t samples;
+};
+
+int imu_fusion_init(struct imu_fusion *f, int rate_hz, double beta);
+void imu_fusion_process(struct imu_fusion *f, const struct imu_batch *batch);
+void imu_fusion_angles(const struct imu_fusion *f, double *roll_deg, double *pitch_deg);
+const char *imu_fusion_kernel_name(const struct imu_fusion *f);
+void imu_fusion_benchmark(int samples);
+
+#endif
@@ -0,0 +1,437 @@
+/*
+파일명: input_mux.c
+작성일: 2026-10-16
+설명: 디지털 입력 에지 이벤트 다중화
+      라인마다 먼저 GPIO uAPI v2로 요청해 커널 디바운스를 걸고,
+      커널이 v2를 지원하지 않으면 libgpiod 이벤트 요청 + 사용자 공간 디바운스로 대체
+      (libgpiod v1에는 디바운스 설정이 없음)
+      사용자 공간 디바운스는 양쪽 에지를 받아 값이 디바운스 창 동안 그대로면 안정된 것으로 보고,
+      마지막으로 넘긴 값과 다를 때만 전이 하나를 넘긴 뒤 받을 에지로 거름
+      (창이 끝났는지는 다음 전이 또는 timerfd로 판단하므로 마지막 전이도 빠지지 않음)
+      어느 쪽이든 요청 fd는 이벤트 루프의 epoll에 등록되므로 입력이 없으면 깨어나지 않음
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "input_mux.h"
+
+static int request_v2(struct input_mux *mux, struct input_line *in, int edges,
+                      int bias, int debounce_us);
+static int request_v1(struct input_mux *mux, struct input_line *in, int edges, int bias);
+static int read_v2(struct input_line *in, struct input_event *out);
+static int read_v1(struct input_line *in, struct input_event *out);
+static int add_settle_timer(struct input_mux *mux, struct input_line *in);
+static int settle(struct input_line *in, int64_t now_ns, struct input_event *out);
+static void deliver(struct input_line *in, const struct input_event *batch, int count);
+static void on_line_event(struct event_source *src, uint32_t events);
+static void on_settle_timer(struct event_source *src, uint32_t events);
+
+// ========== 초기화 ==========
+// 칩 fd는 uAPI v2 요청용으로 따로 열고, 못 열면 모든 라인을 libgpiod로 요청
+int input_mux_init(struct input_mux *mux, struct event_loop *loop,
+                   struct gpiod_chip *chip, const char *chipname)
+{
+  char path[64];
+
+  mux->loop = loop;
+  mux->chip = chip;
+  mux->count = 0;
+
+  snprintf(path, sizeof(path), "/dev/%s", chipname);
+  mux->chip_fd = open(path, O_RDWR | O_CLOEXEC);
+  if (mux->chip_fd < 0)
+  {
+    perror("GPIO chip open for uAPI v2 failed, using libgpiod requests");
+  }
+  return 0;
+}
+
+// ========== 입력 라인 추가 ==========
+// 요청 fd를 이벤트 루프에 등록하고 라인 번호를 돌려줌 (실패하면 -1)
+int input_mux_add(struct input_mux *mux, const char *name, unsigned int pin,
+                  int edges, int bias, int debounce_us)
+{
+  struct input_line *in;
+  int fd;
+
+  if (mux->count >= INPUT_MUX_MAX_LINES)
+  {
+    fprintf(stderr, "input_mux: 입력 라인은 최대 %d개\n", INPUT_MUX_MAX_LINES);
+    return -1;
+  }
+
+  in = &mux->lines[mux->count];
+  memset(in, 0, sizeof(*in));
+  in->mux = mux;
+  in->index = mux->count;
+  in->name = name;
+  in->pin = pin;
+  in->req_fd = -1;
+  in->timer_fd = -1;
+  in->edge_mask = edges;
+
+  fd = request_v2(mux, in, edges, bias, debounce_us);
+  if (fd < 0)
+  {
+    // 커널 디바운스를 못 쓰면 양쪽 에지를 받아 같은 창을 사용자 공간에서 적용
+    // (한쪽 에지만 받으면 되튐의 반대 에지가 안 보여 창을 잴 수 없음)
+    fd = request_v1(mux, in, (debounce_us > 0) ? INPUT_EDGE_BOTH : edges, bias);
+    if (fd < 0)
+    {
+      return -1;
+    }
+    if (debounce_us > 0 && add_settle_timer(mux, in) < 0)
+    {
+      gpiod_line_release(in->line);
+      return -1;
+    }
+    in->debounce_ns = debounce_us * 1000LL;
+  }
+
+  if (event_loop_add(mux->loop, &in->src, fd, on_line_event, in) < 0)
+  {
+    perror("input_mux: event loop add failed");
+    if (in->timer_fd >= 0)
+    {
+      event_loop_remove(mux->loop, &in->timer_src);
+      close(in->timer_fd);
+    }
+    if (in->req_fd >= 0)
+    {
+      close(in->req_fd);
+    }
+    else
+    {
+      gpiod_line_release(in->line);
+    }
+    return -1;
+  }
+
+  return mux->count++;
+}
+
+// ========== 구독 ==========
+int input_mux_subscribe(struct input_mux *mux, int line, input_handler handler, void *arg)
+{
+  struct input_line *in;
+
+  if (line < 0 || line >= mux->count)
+  {
+    return -1;
+  }
+  in = &mux->lines[line];
+  if (in->subscriber_count >= INPUT_MUX_MAX_SUBSCRIBERS)
+  {
+    return -1;
+  }
+
+  in->handlers[in->subscriber_count] = handler;
+  in->args[in->subscriber_count] = arg;
+  in->subscriber_count++;
+  return 0;
+}
+
+// ========== 해제 ==========
+// 라인 수와 통계는 남겨 둠 (종료 후 input_mux_print_stats로 출력)
+void input_mux_close(struct input_mux *mux)
+{
+  for (int i = 0; i < mux->count; i++)
+  {
+    struct input_line *in = &mux->lines[i];
+
+    event_loop_remove(mux->loop, &in->src);
+    if (in->timer_fd >= 0)
+    {
+      event_loop_remove(mux->loop, &in->timer_src);
+      close(in->timer_fd);
+      in->timer_fd = -1;
+    }
+    if (in->req_fd >= 0)
+    {
+      close(in->req_fd);
+    }
+    else
+    {
+      gpiod_line_release(in->line);
+    }
+  }
+
+  if (mux->chip_fd >= 0)
+  {
+    close(mux->chip_fd);
+    mux->chip_fd = -1;
+  }
+}
+
+// ========== 라인별 깨어남 / 전이 통계 출력 ==========
+void input_mux_print_stats(const struct input_mux *mux)
+{
+  for (int i = 0; i < mux->count; i++)
+  {
+    const struct input_line *in = &mux->lines[i];
+
+    printf("입력 %s (GPIO %u, %s 디바운스): 깨어남 %llu회, 전이 %llu개, 채터링 버림 %llu개\n",
+           in->name, in->pin, in->kernel_debounce ? "커널" : "사용자 공간",
+           (unsigned long long)in->wakeups, (unsigned long long)in->edges,
+           (unsigned long long)in->bounces);
+  }
+}
+
+// ========== 라인 이벤트 (메인 루프) ==========
+// 쌓인 이벤트를 한 번에 읽어 구독자에게 묶음으로 전달
+// 사용자 공간 디바운스면 안정된 값의 전이만 남기고, 마지막 전이 후 창이 끝날 때 timerfd로 깨어남
+static void on_line_event(struct event_source *src, uint32_t events)
+{
+  struct input_line *in = src->arg;
+  struct input_event batch[INPUT_MUX_EVENT_BATCH];
+  int count, kept = 0;
+  (void)events;
+
+  in->wakeups++;
+  count = (in->req_fd >= 0) ? read_v2(in, batch) : read_v1(in, batch);
+  if (count < 0)
+  {
+    perror("input_mux: event read failed");
+    return;
+  }
+  if (in->debounce_ns == 0)
+  {
+    deliver(in, batch, count);
+    return;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    struct input_event raw = batch[i];
+
+    // 이 전이 전에 창만큼 그대로였으면 그 값은 안정된 것 (넘긴 자리는 i 이하라 raw를 먼저 복사)
+    kept += settle(in, raw.ts_ns, &batch[kept]);
+    if (in->pending == 0)
+    {
+      in->first_ns = raw.ts_ns;
+    }
+    in->pending++;
+    in->raw_level = raw.value;
+    in->last_ns = raw.ts_ns;
+  }
+  if (in->pending > 0)
+  {
+    timer_arm_at(in->timer_fd, in->last_ns + in->debounce_ns);
+  }
+  deliver(in, batch, kept);
+}
+
+// ========== 디바운스 창 끝 (메인 루프) ==========
+// 마지막 전이 뒤로 창 동안 전이가 없었으면 그 값을 넘김
+// 같은 epoll 묶음에 아직 안 읽은 전이가 있으면 그 타임스탬프로 먼저 판정
+static void on_settle_timer(struct event_source *src, uint32_t events)
+{
+  struct input_line *in = src->arg;
+  struct input_event event;
+  struct timespec no_wait = { 0, 0 };
+  (void)events;
+
+  timer_consume(src->fd);
+  if (gpiod_line_event_wait(in->line, &no_wait) > 0)
+  {
+    on_line_event(&in->src, 0);
+    return;
+  }
+  deliver(in, &event, settle(in, monotonic_ns(), &event));
+}
+
+// ========== 안정 판정 ==========
+// 기다리는 전이가 now_ns까지 창만큼 바뀌지 않았고 마지막으로 넘긴 값과 다르면
+// 받을 에지일 때 out에 채우고 1을 돌려줌 (나머지 전이는 채터링으로 셈)
+static int settle(struct input_line *in, int64_t now_ns, struct input_event *out)
+{
+  bool changed;
+
+  if (in->pending == 0 || now_ns - in->last_ns < in->debounce_ns)
+  {
+    return 0;
+  }
+
+  changed = (in->raw_level != in->level);
+  in->bounces += in->pending - (changed ? 1 : 0);
+  in->pending = 0;
+  if (!changed)
+  {
+    return 0;
+  }
+
+  in->level = in->raw_level;
+  if (!(in->edge_mask & (in->level ? INPUT_EDGE_RISING : INPUT_EDGE_FALLING)))
+  {
+    return 0;
+  }
+  out->line = in->index;
+  out->pin = in->pin;
+  out->value = in->level;
+  out->ts_ns = in->first_ns;   // 되튐이 시작된 시각 (누른 순간)
+  return 1;
+}
+
+// ========== 구독자에게 전달 ==========
+static void deliver(struct input_line *in, const struct input_event *batch, int count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  in->edges += count;
+  for (int i = 0; i < in->subscriber_count; i++)
+  {
+    in->handlers[i](batch, count, in->args[i]);
+  }
+}
+
+// ========== 안정 판정 타이머 등록 (사용자 공간 디바운스) ==========
+// 요청 직후의 값을 마지막으로 넘긴 값으로 삼아 첫 전이도 같은 규칙으로 판정
+static int add_settle_timer(struct input_mux *mux, struct input_line *in)
+{
+  in->level = gpiod_line_get_value(in->line);
+  in->timer_fd = timer_create_fd();
+  if (in->timer_fd < 0)
+  {
+    perror("input_mux: timerfd create failed");
+    return -1;
+  }
+  if (event_loop_add(mux->loop, &in->timer_src, in->timer_fd, on_settle_timer, in) < 0)
+  {
+    perror("input_mux: event loop add failed");
+    close(in->timer_fd);
+    in->timer_fd = -1;
+    return -1;
+  }
+  return 0;
+}
+
+// ========== uAPI v2 요청 (커널 디바운스) ==========
+// 디바운스가 0이면 속성 없이 요청 (v2 이벤트 fd는 같음)
+static int request_v2(struct input_mux *mux, struct input_line *in, int edges,
+                      int bias, int debounce_us)
+{
+  struct gpio_v2_line_request req;
+
+  if (mux->chip_fd < 0)
+  {
+    return -1;
+  }
+
+  memset(&req, 0, sizeof(req));
+  req.offsets[0] = in->pin;
+  req.num_lines = 1;
+  strncpy(req.consumer, in->name, sizeof(req.consumer) - 1);
+
+  req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+  if (edges & INPUT_EDGE_RISING)
+  {
+    req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+  }
+  if (edges & INPUT_EDGE_FALLING)
+  {
+    req.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+  }
+  if (bias == INPUT_BIAS_PULL_UP)
+  {
+    req.config.flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+  }
+  else if (bias == INPUT_BIAS_PULL_DOWN)
+  {
+    req.config.flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+  }
+
+  if (debounce_us > 0)
+  {
+    req.config.num_attrs = 1;
+    req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_DEBOUNCE;
+    req.config.attrs[0].attr.debounce_period_us = debounce_us;
+    req.config.attrs[0].mask = 1;   // offsets[0]에 적용
+  }
+
+  if (ioctl(mux->chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0)
+  {
+    return -1;
+  }
+
+  in->req_fd = req.fd;
+  in->kernel_debounce = (debounce_us > 0);
+  return req.fd;
+}
+
+// ========== libgpiod 요청 (uAPI v2가 없는 커널) ==========
+static int request_v1(struct input_mux *mux, struct input_line *in, int edges, int bias)
+{
+  struct gpiod_line_request_config config;
+
+  in->line = gpiod_chip_get_line(mux->chip, in->pin);
+  if (in->line == NULL)
+  {
+    perror("input_mux: line not found");
+    return -1;
+  }
+
+  config.consumer = in->name;
+  config.request_type = (edges == INPUT_EDGE_BOTH) ? GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES :
+                        (edges == INPUT_EDGE_RISING) ? GPIOD_LINE_REQUEST_EVENT_RISING_EDGE :
+                                                       GPIOD_LINE_REQUEST_EVENT_FALLING_EDGE;
+  config.flags = (bias == INPUT_BIAS_PULL_UP) ? GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP :
+                 (bias == INPUT_BIAS_PULL_DOWN) ? GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_DOWN : 0;
+
+  if (gpiod_line_request(in->line, &config, 0) < 0)
+  {
+    perror("input_mux: edge event request failed");
+    return -1;
+  }
+  return gpiod_line_event_get_fd(in->line);
+}
+
+// ========== uAPI v2 이벤트 읽기 ==========
+static int read_v2(struct input_line *in, struct input_event *out)
+{
+  struct gpio_v2_line_event raw[INPUT_MUX_EVENT_BATCH];
+  ssize_t len = read(in->req_fd, raw, sizeof(raw));
+  int count;
+
+  if (len < 0)
+  {
+    return (errno == EAGAIN) ? 0 : -1;
+  }
+
+  count = len / sizeof(raw[0]);
+  for (int i = 0; i < count; i++)
+  {
+    out[i].line = in->index;
+    out[i].pin = in->pin;
+    out[i].value = (raw[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+    out[i].ts_ns = raw[i].timestamp_ns;
+  }
+  return count;
+}
+
+// ========== libgpiod 이벤트 읽기 ==========
+static int read_v1(struct input_line *in, struct input_event *out)
+{
+  struct gpiod_line_event raw[INPUT_MUX_EVENT_BATCH];
+  int count = gpiod_line_event_read_multiple(in->line, raw, INPUT_MUX_EVENT_BATCH);
+
+  if (count < 0)
+  {
+    return (errno == EAGAIN) ? 0 : -1;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    out[i].line = in->index;
+    out[i].pin = in->pin;
+    out[i].value = (raw[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE);
+    out[i].ts_ns = raw[i].ts.tv_sec * 1000000000LL + raw[i].ts.tv_nsec;
+  }
+  return count;
+}
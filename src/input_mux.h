@@ -0,0 +1,105 @@
+/*
+파일명: input_mux.h
+작성일: 2026-10-16
+설명: 디지털 입력(IR, 라인 트레이서, 버튼) 에지 이벤트 다중화
+      모든 입력 라인을 에지 이벤트로 요청해 이벤트 루프 하나에 등록하고
+      커널 타임스탬프가 붙은 전이를 구독자에게 묶음으로 전달
+      입력이 없으면 깨어나지 않고, 폴링 주기보다 짧은 펄스도 커널 버퍼에 남음
+      채터링은 커널 디바운스(GPIO uAPI v2)로 거르고, 안 되면 양쪽 에지를 받아
+      디바운스 창 동안 바뀌지 않은 값만 넘김 (받을 에지는 그 뒤에 거름)
+ */
+
+#ifndef INPUT_MUX_H
+#define INPUT_MUX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <gpiod.h>
+#include "event_loop.h"
+
+#define INPUT_MUX_MAX_LINES 8         // 최대 입력 라인 수
+#define INPUT_MUX_MAX_SUBSCRIBERS 4   // 라인당 최대 구독자 수
+#define INPUT_MUX_EVENT_BATCH 16      // 한 번에 읽는 최대 이벤트 수 (커널 버퍼 크기)
+
+// ========== 받을 에지 ==========
+enum input_edge
+{
+  INPUT_EDGE_RISING = 1,
+  INPUT_EDGE_FALLING = 2,
+  INPUT_EDGE_BOTH = 3
+};
+
+// ========== 내부 풀업/풀다운 ==========
+enum input_bias
+{
+  INPUT_BIAS_AS_IS = 0,
+  INPUT_BIAS_PULL_UP,
+  INPUT_BIAS_PULL_DOWN
+};
+
+// ========== 전이 하나 ==========
+struct input_event
+{
+  int line;          // input_mux_add가 돌려준 번호
+  unsigned int pin;
+  int value;         // 전이 후 값 (상승 1, 하강 0)
+  int64_t ts_ns;     // 커널 타임스탬프 (CLOCK_MONOTONIC)
+};
+
+// 한 번 깨어날 때 읽은 전이를 묶음째 전달 (메인 루프에서 호출)
+typedef void (*input_handler)(const struct input_event *events, int count, void *arg);
+
+struct input_mux;
+
+// ========== 입력 라인 하나 ==========
+struct input_line
+{
+  struct event_source src;
+  struct input_mux *mux;
+  int index;
+  const char *name;
+  unsigned int pin;
+  struct gpiod_line *line;     // libgpiod 요청 (uAPI v2를 못 쓸 때)
+  int req_fd;                  // uAPI v2 라인 요청 fd (없으면 -1)
+  bool kernel_debounce;        // 커널이 디바운스함
+  int edge_mask;               // 구독자에게 넘길 에지 (enum input_edge)
+
+  // 사용자 공간 디바운스 (커널 디바운스면 debounce_ns = 0, timer_fd = -1)
+  int64_t debounce_ns;         // 이만큼 바뀌지 않아야 안정된 값으로 봄
+  struct event_source timer_src;
+  int timer_fd;                // 마지막 전이 후 창이 끝나면 깨우는 timerfd
+  int level;                   // 마지막으로 넘긴 안정된 값 (모르면 -1)
+  int raw_level;               // 마지막 전이 후 값
+  int pending;                 // 아직 안정 판정을 받지 못한 전이 수
+  int64_t first_ns;            // 그 전이들 중 첫 전이 시각 (넘길 때의 타임스탬프)
+  int64_t last_ns;             // 그 전이들 중 마지막 전이 시각
+
+  input_handler handlers[INPUT_MUX_MAX_SUBSCRIBERS];
+  void *args[INPUT_MUX_MAX_SUBSCRIBERS];
+  int subscriber_count;
+
+  // 통계
+  uint64_t wakeups;            // 이 라인 때문에 루프가 깨어난 횟수
+  uint64_t edges;              // 구독자에게 넘긴 전이 수
+  uint64_t bounces;            // 디바운스 창 안이라 버린 전이 수
+};
+
+// ========== 입력 다중화기 ==========
+struct input_mux
+{
+  struct event_loop *loop;
+  struct gpiod_chip *chip;
+  int chip_fd;                 // uAPI v2 요청용 칩 fd (열지 못하면 -1)
+  int count;
+  struct input_line lines[INPUT_MUX_MAX_LINES];
+};
+
+int input_mux_init(struct input_mux *mux, struct event_loop *loop,
+                   struct gpiod_chip *chip, const char *chipname);
+int input_mux_add(struct input_mux *mux, const char *name, unsigned int pin,
+                  int edges, int bias, int debounce_us);
+int input_mux_subscribe(struct input_mux *mux, int line, input_handler handler, void *arg);
+void input_mux_close(struct input_mux *mux);
+void input_mux_print_stats(const struct input_mux *mux);
+
+#endif
@@ -3,6 +3,8 @@
 작성일: 2026-02-08
 설명: IR 센서로 물체 감지 시 초음파 센서로 거리 측정 후 LED 제어
       거리 데이터는 SQLite DB에 저장하고 I2C LCD에 표시
+      IR/에코 GPIO 이벤트, 타이머, 종료 시그널을 하나의 epoll 루프에서 처리
+      LCD는 렌더 스레드가 그리고 측정 루프는 화면 상태만 발행
  */
 
 #include <stdio.h>      // printf, fprintf 등 표준 입출력 함수
@@ -11,50 +13,151 @@
 #include <time.h>       // clock_gettime (시간 측정) 함수
 #include <stdbool.h>    // bool, true, false 타입 사용
 #include <string.h>     // strlen, memset 등 문자열 함수
-#include <fcntl.h>      // open() 함수
-#include <sys/ioctl.h>  // ioctl() 함수 (I2C 제어)
-#include <linux/i2c-dev.h>  // I2C 디바이스 제어용
 #include <gpiod.h>      // GPIO 제어 라이브러리 (libgpiod)
-#include <sqlite3.h>    // SQLite 데이터베이스 라이브러리
 #include <signal.h>     // 시그널 처리 (Ctrl+C 감지)
+#include <stdint.h>     // int64_t (ns 단위 시각)
+#include <sched.h>      // sched_get_priority_min/max (-p 범위 검사)
+#include "i2c_bus.h"    // 공유 I2C 버스 (LCD, MPU6050)
+#include "lcd.h"        // I2C LCD 16x2 (그림자 버퍼)
+#include "lcd_render.h" // LCD 렌더 스레드 (최신 상태 우편함)
+#include "mpu6050.h"    // MPU6050 가속도/자이로 (FIFO)
+#include "imu_acquire.h" // IMU 수집 스레드 (-i 옵션)
+#include "imu_fusion.h" // IMU 자세 추정 (고정소수점 상보 필터)
+#include "ultrasonic.h" // 초음파 센서 에코 측정 (에지 이벤트)
+#include "sound_speed.h" // 온도 보정 음속 표 (펄스 폭 → 거리)
+#include "dht11.h"      // DHT11 온습도 (-d 옵션, 음속 보정용 온도)
+#include "event_loop.h" // epoll 이벤트 루프, timerfd, signalfd
+#include "input_mux.h"  // IR/라인 트레이서/버튼 에지 이벤트 (디바운스)
+#include "rt_acquire.h" // 측정 스레드 (-r 실시간, -c 연속, -k 버스트)
+#include "ping_scheduler.h" // 연속 측정 적응형 핑 간격 (-c 옵션)
+#include "us_array.h"   // 초음파 센서 배열 (-A 옵션, 그룹별 동시 트리거)
+#include "storage.h"    // SQLite 저장 (준비된 INSERT 문)
+#include "db_writer.h"  // SQLite 전용 쓰기 스레드
 
-// ========== LCD 관련 상수 정의 ==========
-#define LCD_ADDR 0x27       // I2C LCD 주소 (일반적으로 0x27 또는 0x3F)
-#define LCD_BACKLIGHT 0x08  // 백라이트 비트
-#define LCD_ENABLE 0x04     // Enable 비트
-#define LCD_RW 0x02         // Read/Write 비트 (0=쓰기)
-#define LCD_RS 0x01         // Register Select 비트 (0=명령, 1=데이터)
-
-// LCD 명령어
-#define LCD_CLEAR 0x01      // 화면 지우기
-#define LCD_HOME 0x02       // 커서 홈으로
-#define LCD_ENTRY_MODE 0x06 // Entry mode: 커서 오른쪽 이동
-#define LCD_DISPLAY_ON 0x0C // 디스플레이 켜기, 커서 끄기
-#define LCD_FUNCTION_SET 0x28 // 4비트 모드, 2줄, 5x8 폰트
-#define LCD_SET_DDRAM 0x80  // DDRAM 주소 설정
-
-// ========== 전역 변수 ==========
-volatile bool running = true;        // 프로그램 실행 상태
-volatile bool ir_detected = false;   // IR 센서 감지 플래그
-int i2c_fd = -1;                     // I2C 파일 디스크립터
+// ========== 측정 타이밍 상수 ==========
+#define HOLD_NS 2000000000LL    // 측정 결과 LCD 표시 유지 시간 (2초)
+#define SETTLE_NS 10000000LL    // IR 감지 후 측정까지 안정화 시간 (10ms)
+#define COOLDOWN_NS 60000000LL  // 핑 사이 최소 간격 (HC-SR04 잔향 감쇠, 60ms)
+#define LINE_DEBOUNCE_US 1000   // 라인 트레이서 디바운스 (1ms)
+#define BUTTON_DEBOUNCE_US 10000  // 버튼 디바운스 (10ms)
+#define THRESHOLD 20.0          // LED를 켜는 거리 (cm)
+#define IMU_REPORT_NS 1000000000LL  // IMU 요약 출력 간격 (1초)
+#define RANGING_REPORT_NS 1000000000LL  // 연속 측정 요약 출력 간격 (1초)
+
+// ========== 애플리케이션 상태 ==========
+// 이벤트 핸들러들이 공유하는 상태 (event_source.arg로 전달)
+struct app
+{
+  struct event_loop loop;
+
+  // 이벤트 소스: GPIO 이벤트 fd, signalfd, timerfd
+  // (IR, 라인 트레이서, 버튼은 input_mux가 등록)
+  struct event_source echo_src;
+  struct event_source signal_src;
+  struct event_source measure_timer_src;  // 측정 예약 (안정화 + 핑 간격)
+  struct event_source echo_timer_src;     // 에코 대기 마감
+  struct event_source lcd_timer_src;      // 결과 화면 유지 후 대기 화면 복귀
+  int signal_fd;
+  int measure_timer_fd;
+  int echo_timer_fd;
+  int lcd_timer_fd;
+
+  // 측정 스레드 (-r, -c, -k 옵션일 때 사용, -r일 때만 실시간 우선순위)
+  bool rt_mode;
+  bool threaded;               // 측정을 이벤트 루프 대신 측정 스레드가 맡음
+  int burst_size;              // 측정 한 번에 쏘는 핑 수 (-k, 1이면 단일 핑)
+  struct rt_acquire rt;
+  struct event_source rt_src;             // 측정 스레드 결과 알림 (eventfd)
+
+  // 연속 측정 (-c 옵션, 측정 스레드가 IR 없이 적응형 간격으로 핑)
+  bool continuous;
+  int64_t ranging_report_ns;   // 다음 요약 출력 시각
+  int ranging_count;           // 이번 요약 구간의 측정 수
+  int ranging_ok;              // 그중 유효 거리 수
+  double ranging_last_cm;      // 마지막 유효 거리
+
+  // 센서 배열 (-A 옵션, 배열 스레드가 IR 없이 그룹을 돌아가며 핑)
+  bool array_mode;
+  struct us_array array;
+  struct event_source array_src;          // 배열 스레드 결과 알림 (eventfd)
+  double array_last_cm[US_ARRAY_MAX];     // 센서별 최근 거리 (음수면 없음)
+  int64_t array_last_trigger_ns;          // 마지막 슬롯의 트리거 시각 (같은 슬롯 결과 묶기)
+  int array_slots;                        // 이번 요약 구간의 슬롯 수
+  int array_pings[US_ARRAY_MAX];          // 이번 요약 구간의 센서별 측정 수
+  int array_ok[US_ARRAY_MAX];             // 그중 유효 거리 수
+
+  // 디지털 입력 (IR 항상, 라인 트레이서 -L, 버튼 -B)
+  struct input_mux inputs;
+  int line_transitions;        // 라인 트레이서 전이 수
+  int button_presses;          // 버튼 누름 수
+
+  struct gpiod_line *led;
+  struct ultrasonic us;
+  struct storage storage;                 // db_writer 시작 후에는 쓰기 스레드 소유
+  struct storage_config storage_config;
+  struct db_writer writer;
+  struct i2c_bus i2c;                     // /dev/i2c-1 (장치별 우선순위 큐)
+  struct lcd_render display;              // 시작 후에는 LCD를 이 스레드만 사용
+
+  // IMU (-i 옵션일 때만 사용, 같은 I2C 버스에서 높은 우선순위)
+  bool imu_mode;
+  struct mpu6050 mpu;
+  struct imu_acquire imu;
+  struct gpiod_line *imu_int;  // MPU6050 INT 핀 (-m 옵션, 없으면 타이머 모드)
+  struct imu_fusion fusion;    // IMU 스레드만 사용
+  int64_t imu_report_ns;       // 다음 요약 출력 시각 (IMU 스레드만 사용)
+  int imu_report_count;
+  int64_t imu_sum[6];          // ax, ay, az, gx, gy, gz 합
+
+  // DHT11 (-d 옵션일 때만 사용, 읽기 스레드가 온도를 갱신)
+  bool dht_mode;
+  struct gpiod_line *dht_line;
+  struct dht11 dht;
+
+  int num;                     // 처리한 IR 트리거 수
+  int ir_during_measure;       // 초음파 측정 도중 도착한 IR 이벤트 수
+  bool pending;                // 측정 예약됨
+  bool measuring;              // 에코 대기 중
+  int64_t last_ping_ns;        // 마지막 핑 종료 시각
+  int64_t measure_start_ns;    // 진행 중(또는 직전) 측정 시작 시각
+  int64_t measure_end_ns;      // 직전 측정 종료 시각
+  int64_t scheduled_ns;        // 예약된 트리거 시각
+
+  // 트리거 타이밍 통계 (종료 시 출력)
+  int timing_count;
+  int64_t trigger_late_max_ns;   // 예약 시각 → 실제 트리거 최대 지연
+  int64_t trigger_late_sum_ns;
+  int rise_count;
+  int64_t rise_lat_min_ns;       // 트리거 → 에코 상승 타임스탬프 최소/최대
+  int64_t rise_lat_max_ns;
+};
 
 // ========== 함수 선언 ==========
 void check_error(int is_error, int error_code);
-void signal_handler(int sig);
-
-// LCD 관련 함수
-int lcd_init(const char *i2c_device, int lcd_address);
-void lcd_close(void);
-void lcd_write_nibble(unsigned char data, unsigned char mode);
-void lcd_write_byte(unsigned char data, unsigned char mode);
-void lcd_command(unsigned char cmd);
-void lcd_data(unsigned char data);
-void lcd_clear(void);
-void lcd_set_cursor(int row, int col);
-void lcd_print(const char *str);
-void lcd_printf(int row, int col, const char *format, ...);
-
-int main(void)
+void print_usage(const char *prog);
+void print_timing_report(struct app *app);
+
+// 이벤트 핸들러
+void on_signal(struct event_source *src, uint32_t events);
+void on_ir_input(const struct input_event *events, int count, void *arg);
+void on_line_input(const struct input_event *events, int count, void *arg);
+void on_button_input(const struct input_event *events, int count, void *arg);
+void on_echo_event(struct event_source *src, uint32_t events);
+void on_measure_timer(struct event_source *src, uint32_t events);
+void on_echo_timer(struct event_source *src, uint32_t events);
+void on_lcd_timer(struct event_source *src, uint32_t events);
+void on_rt_done(struct event_source *src, uint32_t events);
+void on_array_done(struct event_source *src, uint32_t events);
+void schedule_measurement(struct app *app);
+void complete_measurement(struct app *app, int status, int64_t pulse_ns);
+void finish_measurement(struct app *app, const struct sample *s);
+void show_screen(struct app *app, int screen, double distance, bool led_on);
+void show_nearest(struct app *app);
+void report_ranging(struct app *app, const struct sample *s);
+void report_array(struct app *app, double window_s);
+void on_imu_batch(const struct imu_batch *batch, void *arg);
+
+int main(int argc, char *argv[])
 {
   // ========== GPIO 핀 번호 및 상수 정의 ==========
   const char *chipname = "gpiochip0";
@@ -62,33 +165,223 @@ int main(void)
   const int echo_pin = 17;
   const int ir_pin = 22;
   const int led_pin = 23;
-  const double THRESHOLD = 20.0;
+  const int stop_signals[] = { SIGINT, SIGTERM };
 
   // ========== GPIO 관련 구조체 변수 ==========
   struct gpiod_chip *chip;
-  struct gpiod_line *trig, *echo;
-  struct gpiod_line *ir, *led;
-  struct timespec start, end;
-  struct timespec timeout;
-  struct gpiod_line_event event;
+  struct gpiod_line *trig = NULL, *echo = NULL;
+  static struct app app;
 
   // ========== 일반 변수 ==========
   int error_code = 0;
   int ret = 0;
-  int num = 0;
-  int timeout_count = 0;
+  int opt;
+
+  // ========== 실시간 모드 설정 (-r CPU, -p 우선순위) ==========
+  int rt_cpu = -1;
+  int rt_priority = RT_DEFAULT_PRIORITY;
+
+  // ========== IMU 설정 (-i 샘플레이트, -m INT 핀) ==========
+  int imu_rate = 0;
+  int imu_int_pin = -1;
+
+  // ========== DHT11 설정 (-d 핀) ==========
+  int dht_pin = -1;
+
+  // ========== 센서 배열 설정 (-A 트리거:에코 목록, -g 그룹 수) ==========
+  unsigned int array_trig[US_ARRAY_MAX], array_echo[US_ARRAY_MAX];
+  int array_count = 0;
+  int array_groups = US_ARRAY_DEFAULT_GROUPS;
+
+  // ========== 추가 입력 설정 (-L 라인 트레이서 핀, -B 버튼 핀) ==========
+  int line_pin = -1;
+  int button_pin = -1;
+  int input;
+
+  // ========== 저장 설정 (-b 행 수, -t 밀리초, -s synchronous) ==========
+  app.storage_config.batch_rows = 0;   // 행 수 제한 없음 (-t만 주면 시간 창으로만 커밋)
+  app.storage_config.batch_ms = 0;
+  app.storage_config.synchronous = NULL;
+  app.storage_config.compact = false;
+
+  // ========== 파티션 설정 (-P 디렉터리, -W 구간 초, -Q 크기 MB, -D 보관 일수) ==========
+  const char *db_path = "ultrasonic.db";
+  const char *partition_dir = NULL;
+  int partition_s = PARTITION_DEFAULT_WINDOW_S;
+  app.storage_config.partition_s = 0;
+  app.storage_config.budget.max_bytes = 0;
+  app.storage_config.budget.max_age_s = 0;
+
+  // ========== 바이너리 로그 설정 (-S 디렉터리) ==========
+  const char *log_dir = NULL;
+  app.storage_config.log_records = 0;
+
+  // ========== 명령행 옵션 ==========
+  while ((opt = getopt(argc, argv, "r:p:b:t:s:CP:W:Q:D:S:li:m:d:ck:A:g:L:B:Fh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'b':
+        app.storage_config.batch_rows = atoi(optarg);
+        break;
+      case 't':
+        app.storage_config.batch_ms = atoi(optarg);
+        break;
+      case 's':
+        if (strcmp(optarg, "OFF") != 0 && strcmp(optarg, "NORMAL") != 0 &&
+            strcmp(optarg, "FULL") != 0 && strcmp(optarg, "EXTRA") != 0)
+        {
+          fprintf(stderr, "synchronous 값은 OFF, NORMAL, FULL, EXTRA 중 하나\n");
+          exit(1);
+        }
+        app.storage_config.synchronous = optarg;
+        break;
+      case 'C':
+        app.storage_config.compact = true;
+        break;
+      case 'P':
+        partition_dir = optarg;
+        break;
+      case 'S':
+        log_dir = optarg;
+        break;
+      case 'W':
+        partition_s = atoi(optarg);
+        if (partition_s < 60)
+        {
+          fprintf(stderr, "파티션 구간은 60초 이상\n");
+          exit(1);
+        }
+        break;
+      case 'Q':
+        app.storage_config.budget.max_bytes = atoll(optarg) * 1024 * 1024;
+        break;
+      case 'D':
+        app.storage_config.budget.max_age_s = atoll(optarg) * 86400;
+        break;
+      case 'r':
+        app.rt_mode = true;
+        rt_cpu = atoi(optarg);
+        break;
+      case 'p':
+        // 0은 SCHED_FIFO가 아니라 일반 스레드가 되므로 FIFO 범위만 받음
+        rt_priority = atoi(optarg);
+        if (rt_priority < sched_get_priority_min(SCHED_FIFO) ||
+            rt_priority > sched_get_priority_max(SCHED_FIFO))
+        {
+          fprintf(stderr, "SCHED_FIFO 우선순위는 %d ~ %d\n",
+                  sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+          exit(1);
+        }
+        break;
+      case 'c':
+        app.continuous = true;
+        break;
+      case 'k':
+        app.burst_size = atoi(optarg);
+        if (app.burst_size < 1 || app.burst_size > BURST_MAX)
+        {
+          fprintf(stderr, "버스트 핑 수는 1 ~ %d\n", BURST_MAX);
+          exit(1);
+        }
+        break;
+      case 'A':
+        app.array_mode = true;
+        array_count = us_array_parse(optarg, array_trig, array_echo);
+        if (array_count < 0)
+        {
+          fprintf(stderr, "센서 배열은 트리거:에코 쌍을 쉼표로 구분 (최대 %d개, 예: 27:17,5:6)\n",
+                  US_ARRAY_MAX);
+          exit(1);
+        }
+        break;
+      case 'g':
+        array_groups = atoi(optarg);
+        break;
+      case 'L':
+        line_pin = atoi(optarg);
+        break;
+      case 'B':
+        button_pin = atoi(optarg);
+        break;
+      case 'l':
+        // 긴 LCD 명령 뒤 고정 대기 대신 busy flag 읽기
+        lcd_use_busy_flag(true);
+        break;
+      case 'i':
+        app.imu_mode = true;
+        imu_rate = atoi(optarg);
+        break;
+      case 'm':
+        imu_int_pin = atoi(optarg);
+        break;
+      case 'd':
+        app.dht_mode = true;
+        dht_pin = atoi(optarg);
+        break;
+      case 'F':
+        // 하드웨어 없이 자세 추정 처리량만 재고 종료
+        imu_fusion_benchmark(50000000);
+        exit(0);
+      default:
+        print_usage(argv[0]);
+        exit(opt == 'h' ? 0 : 1);
+    }
+  }
 
-  // ========== SQLite 관련 변수 ==========
-  sqlite3 *db;
-  char *err_msg = NULL;
-  char sql[256];
-  
-  // ========== 시그널 핸들러 등록 ==========
-  signal(SIGINT, signal_handler);
+  // 구간/예산은 파티션 디렉터리가 있을 때만 의미가 있음
+  // 바이너리 로그는 SQLite를 열지 않으므로 스키마/파티션 옵션과 함께 쓰지 않음
+  if (log_dir != NULL)
+  {
+    if (partition_dir != NULL || app.storage_config.compact)
+    {
+      fprintf(stderr, "-S는 -P, -C와 함께 쓸 수 없음 (db_load가 ultrasonic 테이블로 옮김)\n");
+      exit(1);
+    }
+    db_path = log_dir;
+    app.storage_config.log_records = SAMPLE_LOG_DEFAULT_RECORDS;
+  }
+  if (partition_dir != NULL)
+  {
+    db_path = partition_dir;
+    app.storage_config.partition_s = partition_s;
+  }
+  else if (partition_s != PARTITION_DEFAULT_WINDOW_S ||
+           app.storage_config.budget.max_bytes > 0 || app.storage_config.budget.max_age_s > 0)
+  {
+    fprintf(stderr, "-W, -Q, -D는 -P 디렉터리와 함께 사용\n");
+    exit(1);
+  }
+
+  // 연속 측정과 버스트 측정은 핑 간격을 측정 스레드가 직접 재므로 스레드 사용
+  if (app.burst_size < 1)
+  {
+    app.burst_size = 1;
+  }
+  app.threaded = app.rt_mode || app.continuous || app.burst_size > 1;
+
+  // 센서 배열은 자체 스레드가 슬롯 간격을 정하므로 단일 센서 측정 스레드와 함께 쓰지 않음
+  if (app.array_mode && app.threaded)
+  {
+    fprintf(stderr, "-A는 -r, -c, -k와 함께 쓸 수 없음\n");
+    exit(1);
+  }
+  for (int i = 0; i < US_ARRAY_MAX; i++)
+  {
+    app.array_last_cm[i] = -1.0;
+  }
+
+  // ========== 종료 시그널을 signalfd로 받기 ==========
+  // 시그널은 여기서 막히므로 이후 어떤 대기 중에도 핸들러가 끼어들지 않음
+  app.signal_fd = signal_create_fd(stop_signals, 2);
+  error_code = 10;
+  check_error(app.signal_fd < 0, error_code);
 
   // ========== I2C LCD 초기화 ==========
   printf("I2C LCD 초기화 중...\n");
-  if (lcd_init("/dev/i2c-1", LCD_ADDR) < 0) 
+  // 버스 fd는 여기서 한 번만 열고 LCD(와 다른 I2C 장치)는 주소로만 구분
+  if (i2c_bus_open(&app.i2c, "/dev/i2c-1") < 0 ||
+      lcd_init(&app.i2c, LCD_ADDR) < 0) 
   {
     fprintf(stderr, "LCD 초기화 실패!\n");
     fprintf(stderr, "다음을 확인하세요:\n");
@@ -99,30 +392,21 @@ int main(void)
   }
 
   // LCD 시작 메시지
-  lcd_clear();
-  lcd_print("IR+Ultrasonic");
-  lcd_set_cursor(1, 0);
-  lcd_print("System Ready");
+  lcd_show("IR+Ultrasonic", "System Ready");
   sleep(2);
 
   // ========== SQLite 데이터베이스 초기화 ==========
-  int rc = sqlite3_open("ultrasonic.db", &db);
-  check_error(rc != SQLITE_OK, error_code);
-
-  const char *create_table_sql = 
-      "CREATE TABLE IF NOT EXISTS ultrasonic("
-      "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-      "measurement_num INT, "
-      "distance REAL, "
-      "ir_triggered BOOL, "
-      "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP);";
-    
-  rc = sqlite3_exec(db, create_table_sql, 0, 0, &err_msg);
-  if (rc != SQLITE_OK) 
+  // 테이블 생성과 INSERT 문 준비까지 storage_open에서 처리 (-P면 파티션 디렉터리, -S면 로그 디렉터리)
+  if (storage_open(&app.storage, db_path, &app.storage_config) < 0)
+  {
+    lcd_close();
+    exit(1);
+  }
+
+  // 이후 sqlite3 핸들은 쓰기 스레드만 사용 (측정 루프는 링에 넣기만 함)
+  if (db_writer_start(&app.writer, &app.storage) < 0)
   {
-    fprintf(stderr, "SQL error: %s\n", err_msg);
-    sqlite3_free(err_msg);
-    sqlite3_close(db);
+    storage_close(&app.storage);
     lcd_close();
     exit(1);
   }
@@ -132,418 +416,897 @@ int main(void)
   error_code = 1;
   check_error(chip == NULL, error_code);
 
-  // ========== 트리거 핀 설정 ==========
-  trig = gpiod_chip_get_line(chip, trig_pin);
-  error_code = 2;
-  check_error(trig == NULL, error_code);
-
-  // ========== 에코 핀 설정 ==========
-  echo = gpiod_chip_get_line(chip, echo_pin);
-  error_code = 3;
-  check_error(echo == NULL, error_code);
+  // ========== 트리거 / 에코 핀 설정 ==========
+  // 센서 배열이면 배열의 트리거/에코 라인을 각각 bulk로 한 번에 요청
+  if (app.array_mode)
+  {
+    ret = us_array_open(&app.array, chip, array_trig, array_echo, array_count, array_groups);
+    error_code = 15;
+    check_error(ret < 0, error_code);
+  }
+  else
+  {
+    trig = gpiod_chip_get_line(chip, trig_pin);
+    error_code = 2;
+    check_error(trig == NULL, error_code);
 
-  // ========== IR 센서 핀 설정 ==========
-  ir = gpiod_chip_get_line(chip, ir_pin);
-  error_code = 4;
-  check_error(ir == NULL, error_code);
+    echo = gpiod_chip_get_line(chip, echo_pin);
+    error_code = 3;
+    check_error(echo == NULL, error_code);
+  }
 
   // ========== LED 핀 설정 ==========
-  led = gpiod_chip_get_line(chip, led_pin);
+  app.led = gpiod_chip_get_line(chip, led_pin);
   error_code = 5;
-  check_error(led == NULL, error_code);
+  check_error(app.led == NULL, error_code);
 
   // ========== 핀 모드 설정 ==========
-  ret = gpiod_line_request_output(trig, "trig", 0);
-  error_code = 6;
+  if (!app.array_mode)
+  {
+    ret = gpiod_line_request_output(trig, "trig", 0);
+    error_code = 6;
+    check_error(ret < 0, error_code);
+
+    // 에코는 양방향 에지 이벤트로 요청 (커널 타임스탬프로 펄스 폭 측정)
+    ret = ultrasonic_init(&app.us, trig, echo);
+    error_code = 7;
+    check_error(ret < 0, error_code);
+  }
+
+  ret = gpiod_line_request_output(app.led, "led", 0);
+  error_code = 9;
   check_error(ret < 0, error_code);
 
-  ret = gpiod_line_request_input(echo, "echo");
-  error_code = 7;
+  // ========== 이벤트 루프 구성 ==========
+  // 입력/에코 이벤트 fd, signalfd, 타이머 fd를 모두 하나의 epoll에 등록
+  error_code = 10;
+  check_error(event_loop_init(&app.loop) < 0, error_code);
+
+  app.measure_timer_fd = timer_create_fd();
+  app.echo_timer_fd = timer_create_fd();
+  app.lcd_timer_fd = timer_create_fd();
+  check_error(app.measure_timer_fd < 0 || app.echo_timer_fd < 0 ||
+              app.lcd_timer_fd < 0, error_code);
+
+  ret = event_loop_add(&app.loop, &app.signal_src, app.signal_fd, on_signal, &app);
+  ret |= event_loop_add(&app.loop, &app.measure_timer_src, app.measure_timer_fd,
+                        on_measure_timer, &app);
+  ret |= event_loop_add(&app.loop, &app.echo_timer_src, app.echo_timer_fd,
+                        on_echo_timer, &app);
+  ret |= event_loop_add(&app.loop, &app.lcd_timer_src, app.lcd_timer_fd,
+                        on_lcd_timer, &app);
   check_error(ret < 0, error_code);
-  
-  ret = gpiod_line_request_falling_edge_events(ir, "ir_sensor");
+
+  // ========== 디지털 입력 (IR, 라인 트레이서, 버튼) ==========
+  // 모두 에지 이벤트로 요청해 같은 epoll에 등록하므로 입력이 없으면 루프가 깨어나지 않음
+  input_mux_init(&app.inputs, &app.loop, chip, chipname);
+  input = input_mux_add(&app.inputs, "ir_sensor", ir_pin, INPUT_EDGE_FALLING,
+                        INPUT_BIAS_AS_IS, 0);
   error_code = 8;
-  check_error(ret < 0, error_code);
+  check_error(input < 0 || input_mux_subscribe(&app.inputs, input, on_ir_input, &app) < 0,
+              error_code);
+  if (line_pin >= 0)
+  {
+    input = input_mux_add(&app.inputs, "line_trace", line_pin, INPUT_EDGE_BOTH,
+                          INPUT_BIAS_AS_IS, LINE_DEBOUNCE_US);
+    error_code = 16;
+    check_error(input < 0 ||
+                input_mux_subscribe(&app.inputs, input, on_line_input, &app) < 0,
+                error_code);
+  }
+  if (button_pin >= 0)
+  {
+    // 버튼은 GND로 연결하고 내부 풀업 사용 (누르면 하강 에지)
+    input = input_mux_add(&app.inputs, "button", button_pin, INPUT_EDGE_FALLING,
+                          INPUT_BIAS_PULL_UP, BUTTON_DEBOUNCE_US);
+    error_code = 16;
+    check_error(input < 0 ||
+                input_mux_subscribe(&app.inputs, input, on_button_input, &app) < 0,
+                error_code);
+  }
 
-  ret = gpiod_line_request_output(led, "led", 0);
-  error_code = 9;
-  check_error(ret < 0, error_code);
+  if (app.array_mode)
+  {
+    // 센서 배열: 배열 스레드가 슬롯마다 한 그룹을 쏘고 센서별 결과를 링에 넣음
+    ret = us_array_start(&app.array);
+    error_code = 15;
+    check_error(ret < 0, error_code);
+
+    ret = event_loop_add(&app.loop, &app.array_src, us_array_done_fd(&app.array),
+                         on_array_done, &app);
+    error_code = 10;
+    check_error(ret < 0, error_code);
+    printf("센서 배열: %d개, %d그룹 (슬롯마다 한 그룹 동시 트리거, IR 감지와 무관)\n",
+           app.array.count, app.array.groups);
+  }
+  else if (app.threaded)
+  {
+    // 실시간 모드: 트리거와 에코 측정은 전용 스레드가 맡고
+    // 메인 루프는 결과 알림 eventfd만 기다림
+    // -r 없이 연속/버스트 측정만 켠 경우에는 SCHED_FIFO 없는 일반 스레드로 실행
+    ret = rt_acquire_start(&app.rt, &app.us, rt_cpu, app.rt_mode ? rt_priority : 0,
+                           app.continuous, app.burst_size);
+    error_code = 11;
+    check_error(ret < 0, error_code);
+
+    ret = event_loop_add(&app.loop, &app.rt_src, rt_acquire_done_fd(&app.rt),
+                         on_rt_done, &app);
+    error_code = 10;
+    check_error(ret < 0, error_code);
+    if (app.rt_mode)
+    {
+      printf("실시간 측정 스레드: SCHED_FIFO %d, CPU %d\n", rt_priority, rt_cpu);
+    }
+    if (app.continuous)
+    {
+      printf("연속 측정: 직전 에코에 따라 %.0f~%.0f ms 간격으로 핑 (IR 감지와 무관)\n",
+             PING_MIN_INTERVAL_NS / 1e6, PING_MAX_INTERVAL_NS / 1e6);
+    }
+    if (app.burst_size > 1)
+    {
+      printf("버스트 측정: 측정마다 핑 %d회의 중앙값 (최대 %.0f ms)\n",
+             app.burst_size, app.burst_size * PING_MAX_INTERVAL_NS / 1e6);
+    }
+  }
+  else if (ultrasonic_event_fd(&app.us) >= 0)
+  {
+    // 에코가 폴링 모드로 대체된 경우에는 등록할 fd가 없음
+    ret = event_loop_add(&app.loop, &app.echo_src, ultrasonic_event_fd(&app.us),
+                         on_echo_event, &app);
+    check_error(ret < 0, error_code);
+  }
 
   // ========== 시작 메시지 출력 ==========
   printf("IR 센서 + 초음파 센서 + LCD 통합 시스템 시작\n");
   printf("IR 센서가 물체를 감지하면 초음파로 거리 측정\n");
   printf("거리 %.1f cm 이내면 LED ON\n\n", THRESHOLD);
 
-  // LCD 대기 화면
-  lcd_clear();
-  lcd_print("Waiting for");
-  lcd_set_cursor(1, 0);
-  lcd_print("IR Detection...");
-
-  // ========== 인터럽트 대기 타임아웃 설정 ==========
-  timeout.tv_sec = 1;
-  timeout.tv_nsec = 0;
-
-  // ========== 메인 루프 ==========
-  while(running)
+  // ========== IMU 수집 시작 ==========
+  // LCD와 같은 버스를 쓰지만 센서 우선순위라 LCD 전송보다 먼저 나감
+  if (app.imu_mode)
   {
-    // ========== IR 센서 인터럽트 대기 ==========
-    ret = gpiod_line_event_wait(ir, &timeout);
+    error_code = 13;
+    check_error(mpu6050_init(&app.mpu, &app.i2c, MPU6050_ADDR, imu_rate) < 0,
+                error_code);
+    check_error(imu_fusion_init(&app.fusion, app.mpu.rate_hz,
+                                IMU_FUSION_DEFAULT_BETA) < 0, error_code);
 
-    if (ret < 0) 
+    // INT 핀이 연결돼 있으면 IR 센서처럼 에지 이벤트로 요청
+    // (data-ready 에지의 커널 타임스탬프가 샘플 시각이 됨)
+    if (imu_int_pin >= 0)
     {
-      perror("Error waiting for IR event");
-      break;
+      app.imu_int = gpiod_chip_get_line(chip, imu_int_pin);
+      check_error(app.imu_int == NULL, error_code);
+      ret = gpiod_line_request_rising_edge_events(app.imu_int, "mpu6050_int");
+      check_error(ret < 0, error_code);
     }
-    else if (ret == 0) 
+
+    check_error(imu_acquire_start(&app.imu, &app.mpu, IMU_DEFAULT_DRAIN_MS,
+                                  app.imu_int, on_imu_batch, &app) < 0, error_code);
+    if (app.imu_int != NULL)
     {
-      continue;
+      printf("IMU 수집: %d Hz, GPIO %d data-ready 인터럽트 %d개마다 FIFO 읽기\n",
+             app.mpu.rate_hz, imu_int_pin, app.imu.watermark);
     }
-
-    // ========== 이벤트 읽기 ==========
-    ret = gpiod_line_event_read(ir, &event);
-    if (ret < 0) 
+    else
     {
-      perror("Error reading IR event");
-      continue;
+      printf("IMU 수집: %d Hz, FIFO %d ms마다 버스트 읽기\n",
+             app.mpu.rate_hz, IMU_DEFAULT_DRAIN_MS);
     }
+  }
 
-    // ========== IR 센서가 물체 감지 ==========
-    printf("\nIR 센서 감지! 초음파 측정 시작...\n");
-    num++;
-    ir_detected = true;
+  // ========== DHT11 읽기 스레드 시작 ==========
+  // 읽기가 끝날 때마다 온도만 갱신하고, 거리 계산은 그 값으로 음속 표를 고름
+  if (app.dht_mode)
+  {
+    error_code = 14;
+    app.dht_line = gpiod_chip_get_line(chip, dht_pin);
+    check_error(app.dht_line == NULL, error_code);
+    check_error(dht11_init(&app.dht, app.dht_line) < 0, error_code);
+    check_error(dht11_start(&app.dht, DHT11_DEFAULT_INTERVAL_MS) < 0, error_code);
+    printf("DHT11: GPIO %d, %d ms마다 온도 갱신 (음속 보정)\n",
+           dht_pin, DHT11_DEFAULT_INTERVAL_MS);
+  }
+
+  // ========== LCD 렌더 스레드 시작 ==========
+  // 이후 화면 갱신은 상태 발행만 하고 I2C 전송은 렌더 스레드가 맡음
+  ret = lcd_render_start(&app.display, LCD_RENDER_DEFAULT_FPS);
+  error_code = 12;
+  check_error(ret < 0, error_code);
 
-    // LCD에 감지 표시
-    lcd_clear();
-    lcd_print("IR Detected!");
-    lcd_set_cursor(1, 0);
-    lcd_print("Measuring...");
+  // LCD 대기 화면
+  show_screen(&app, LCD_SCREEN_WAITING, 0.0, false);
 
-    // ========== 센서 안정화 대기 ==========
-    usleep(10000);
+  // ========== 메인 루프 ==========
+  // 프로그램이 잠드는 곳은 epoll_wait 한 곳뿐
+  // 결과 표시 유지, 측정 간격, 에코 마감은 모두 timerfd로 처리
+  event_loop_run(&app.loop);
 
-    // ========== 초음파 센서 트리거 신호 발생 ==========
-    gpiod_line_set_value(trig, 0);
-    usleep(2);
+  // ========== 프로그램 종료 처리 ==========
+  printf("\n프로그램 종료 중...\n");
 
-    gpiod_line_set_value(trig, 1);
-    usleep(10);
+  // 렌더 스레드를 멈춘 뒤에는 다시 메인이 LCD를 직접 사용
+  lcd_render_stop(&app.display);
+    
+  // LCD 종료 메시지
+  lcd_show("System", "Shutting Down");
+  sleep(1);
     
-    gpiod_line_set_value(trig, 0);
+  gpiod_line_set_value(app.led, 0);
 
-    // ========== 에코 신호 HIGH 대기 ==========
-    timeout_count = 0;
+  if (app.threaded)
+  {
+    rt_acquire_stop(&app.rt);
+  }
+  if (app.array_mode)
+  {
+    us_array_stop(&app.array);
+  }
+
+  if (app.imu_mode)
+  {
+    imu_acquire_stop(&app.imu);
+    mpu6050_close(&app.mpu);
+    if (app.imu_int != NULL)
+    {
+      gpiod_line_release(app.imu_int);
+    }
+  }
+
+  if (app.dht_mode)
+  {
+    dht11_stop(&app.dht);
+    dht11_release(&app.dht);
+  }
+
+  input_mux_close(&app.inputs);
+  event_loop_close(&app.loop);
+  close(app.measure_timer_fd);
+  close(app.echo_timer_fd);
+  close(app.lcd_timer_fd);
+  close(app.signal_fd);
+    
+  if (app.array_mode)
+  {
+    us_array_close(&app.array);
+  }
+  else
+  {
+    gpiod_line_release(trig);
+    ultrasonic_release(&app.us);
+  }
+  gpiod_line_release(app.led);
     
-    while(gpiod_line_get_value(echo) == 0)
+  gpiod_chip_close(chip);
+  // 쓰기 스레드가 남은 레코드를 모두 쓰고 커밋한 뒤 DB 닫기
+  db_writer_stop(&app.writer);
+  storage_close(&app.storage);
+  lcd_close();
+  i2c_bus_close(&app.i2c);
+    
+  printf("총 %d개의 IR 트리거 이벤트가 처리되었습니다.\n", app.num);
+  printf("측정 도중 도착한 IR 이벤트: %d개\n", app.ir_during_measure);
+  if (line_pin >= 0 || button_pin >= 0)
+  {
+    printf("라인 트레이서 전이: %d개, 버튼 누름: %d회\n",
+           app.line_transitions, app.button_presses);
+  }
+  print_timing_report(&app);
+  if (app.continuous)
+  {
+    ping_scheduler_print_stats(&app.rt.sched);
+  }
+  if (app.threaded)
+  {
+    burst_print_stats(&app.rt.burst);
+  }
+  if (app.array_mode)
+  {
+    us_array_print_stats(&app.array);
+  }
+  storage_print_stats(&app.storage);
+  input_mux_print_stats(&app.inputs);
+  if (app.imu_mode)
+  {
+    imu_acquire_print_stats(&app.imu);
+  }
+  if (app.dht_mode)
+  {
+    dht11_print_stats(&app.dht);
+  }
+  lcd_render_print_stats(&app.display);
+  lcd_print_stats();
+  i2c_bus_print_stats(&app.i2c);
+  printf("DB 링 버퍼가 가득 차서 버린 행: %u개\n", db_writer_dropped(&app.writer));
+
+  return 0;
+}
+
+// ========== 종료 시그널 (SIGINT, SIGTERM) ==========
+void on_signal(struct event_source *src, uint32_t events)
+{
+  struct app *app = src->arg;
+  (void)events;
+
+  if (signal_consume(src->fd) > 0)
+  {
+    printf("\n종료 신호를 받았습니다...\n");
+    event_loop_stop(&app->loop);
+  }
+}
+
+// ========== IR 센서 입력 ==========
+// 한 번 깨어날 때 쌓인 하강 에지를 묶음으로 받고, 측정이 진행 중이 아니면 측정을 예약
+void on_ir_input(const struct input_event *events, int count, void *arg)
+{
+  struct app *app = arg;
+
+  for (int i = 0; i < count; i++)
+  {
+    // 초음파 측정 도중에 들어온 IR 이벤트
+    if (events[i].ts_ns >= app->measure_start_ns &&
+        (app->measuring || events[i].ts_ns <= app->measure_end_ns))
     {
-      usleep(1);
-      if(++timeout_count > 30000) 
-      {
-        printf("Echo timeout (waiting for HIGH)\n");
-        lcd_clear();
-        lcd_print("Timeout Error!");
-        lcd_set_cursor(1, 0);
-        lcd_print("Please retry");
-        sleep(2);
-        break;
-      }
+      app->ir_during_measure++;
     }
+  }
 
-    if(timeout_count > 30000) 
+  app->num += count;
+  printf("\nIR 센서 감지! (누적 %d회)\n", app->num);
+
+  // 연속 측정, 센서 배열 중에는 IR 감지가 측정을 예약하지 않음 (횟수만 셈)
+  if (!app->pending && !app->continuous && !app->array_mode)
+  {
+    app->pending = true;
+    // 측정 중이면 측정이 끝날 때 finish_measurement에서 예약
+    if (!app->measuring)
     {
-      ir_detected = false;
-      lcd_clear();
-      lcd_print("Waiting for");
-      lcd_set_cursor(1, 0);
-      lcd_print("IR Detection...");
-      continue;
+      schedule_measurement(app);
     }
+  }
+}
 
-    // ========== 에코 신호 시작 시간 기록 ==========
-    clock_gettime(CLOCK_MONOTONIC, &start);
+// ========== 측정 예약 ==========
+// 안정화 시간과 이전 핑과의 간격을 모두 만족하는 시각에 측정 타이머 설정
+void schedule_measurement(struct app *app)
+{
+  int64_t measure_at_ns = monotonic_ns() + SETTLE_NS;
 
-    // ========== 에코 신호 LOW 대기 ==========
-    timeout_count = 0;
+  if (measure_at_ns < app->last_ping_ns + COOLDOWN_NS)
+  {
+    measure_at_ns = app->last_ping_ns + COOLDOWN_NS;
+  }
+  app->scheduled_ns = measure_at_ns;
 
-    while(gpiod_line_get_value(echo) == 1)
+  if (app->threaded)
+  {
+    // 측정 스레드가 예약 시각에 직접 깨어나 트리거
+    app->pending = false;
+    app->measuring = true;
+    app->measure_start_ns = measure_at_ns;
+    rt_acquire_request(&app->rt, measure_at_ns, app->num);
+    return;
+  }
+
+  timer_arm_at(app->measure_timer_fd, measure_at_ns);
+}
+
+// ========== 측정 타이머 만료 → 트리거 ==========
+void on_measure_timer(struct event_source *src, uint32_t events)
+{
+  struct app *app = src->arg;
+  int64_t pulse_ns = 0;
+  int status;
+  (void)events;
+
+  timer_consume(src->fd);
+  if (!app->pending || app->measuring)
+  {
+    return;
+  }
+
+  app->pending = false;
+  app->measure_start_ns = monotonic_ns();
+
+  if (ultrasonic_event_fd(&app->us) < 0)
+  {
+    // 폴링 모드: 마감 시간 안에서 블로킹 측정
+    status = ultrasonic_measure(&app->us, &pulse_ns);
+    complete_measurement(app, status, pulse_ns);
+    return;
+  }
+
+  // 이벤트 모드: 트리거 후 에코 fd와 마감 타이머로 결과를 기다림
+  app->measuring = true;
+  timer_arm_at(app->echo_timer_fd, ultrasonic_start(&app->us));
+}
+
+// ========== 에코 에지 이벤트 ==========
+void on_echo_event(struct event_source *src, uint32_t events)
+{
+  struct app *app = src->arg;
+  int64_t pulse_ns = 0;
+  int status;
+  (void)events;
+
+  // 측정 중이 아닐 때 들어온 늦은 에지는 버림
+  if (!app->measuring)
+  {
+    ultrasonic_drain(&app->us);
+    return;
+  }
+
+  status = ultrasonic_read_events(&app->us, &pulse_ns);
+  if (status != US_PENDING)
+  {
+    complete_measurement(app, status, pulse_ns);
+  }
+}
+
+// ========== 에코 마감 시각 도달 ==========
+void on_echo_timer(struct event_source *src, uint32_t events)
+{
+  struct app *app = src->arg;
+  int64_t pulse_ns = 0;
+  (void)events;
+
+  timer_consume(src->fd);
+  if (app->measuring)
+  {
+    complete_measurement(app, ultrasonic_finish(&app->us, &pulse_ns), pulse_ns);
+  }
+}
+
+// ========== 결과 화면 유지 시간 만료 → 대기 화면 ==========
+void on_lcd_timer(struct event_source *src, uint32_t events)
+{
+  (void)events;
+
+  timer_consume(src->fd);
+  show_screen(src->arg, LCD_SCREEN_WAITING, 0.0, false);
+}
+
+// ========== 실시간 스레드 결과 도착 ==========
+void on_rt_done(struct event_source *src, uint32_t events)
+{
+  struct app *app = src->arg;
+  struct sample s;
+  (void)events;
+
+  while (rt_acquire_poll(&app->rt, &s))
+  {
+    finish_measurement(app, &s);
+  }
+}
+
+// ========== 라인 트레이서 입력 ==========
+// 전이마다 값과 커널 타임스탬프만 출력 (폴링 주기 사이의 짧은 통과도 남음)
+void on_line_input(const struct input_event *events, int count, void *arg)
+{
+  struct app *app = arg;
+
+  for (int i = 0; i < count; i++)
+  {
+    printf("라인 센서 %s (%.6f s)\n", events[i].value ? "HIGH" : "LOW", events[i].ts_ns / 1e9);
+  }
+  app->line_transitions += count;
+}
+
+// ========== 버튼 입력 ==========
+// 누르면 결과 화면을 닫고 LED를 끔 (다음 측정 결과가 오면 다시 표시)
+void on_button_input(const struct input_event *events, int count, void *arg)
+{
+  struct app *app = arg;
+  (void)events;
+
+  app->button_presses += count;
+  printf("버튼 눌림 (누적 %d회): 결과 화면 닫기\n", app->button_presses);
+
+  timer_disarm(app->lcd_timer_fd);
+  gpiod_line_set_value(app->led, 0);
+  show_screen(app, LCD_SCREEN_WAITING, 0.0, false);
+}
+
+// ========== 센서 배열 슬롯 결과 도착 ==========
+// 한 슬롯에서 그룹 센서 수만큼 레코드가 들어옴
+void on_array_done(struct event_source *src, uint32_t events)
+{
+  struct app *app = src->arg;
+  struct sample s;
+  (void)events;
+
+  while (us_array_poll(&app->array, &s))
+  {
+    finish_measurement(app, &s);
+  }
+}
+
+// ========== 메인 루프에서 끝난 측정을 레코드로 ==========
+void complete_measurement(struct app *app, int status, int64_t pulse_ns)
+{
+  struct sample s;
+
+  s.scheduled_ns = app->scheduled_ns;
+  s.trigger_ns = app->us.trigger_ns;
+  s.rise_ns = (status == US_OK) ? app->us.rise_ns : 0;
+  s.pulse_ns = pulse_ns;
+  s.spread_ns = -1;
+  s.status = status;
+  s.num = app->num;
+  s.ir_triggered = 1;
+  s.pings = (status == US_OK) ? 1 : 0;
+  s.sensor_id = 0;
+  finish_measurement(app, &s);
+}
+
+// ========== 측정 완료 처리 ==========
+// 결과 출력, LED/LCD 갱신, DB 저장 후 결과 화면 유지 타이머 설정
+void finish_measurement(struct app *app, const struct sample *s)
+{
+  int status = s->status;
+  int64_t late_ns = s->trigger_ns - s->scheduled_ns;
+  // 연속 측정과 센서 배열은 핑마다 출력하지 않고 1초 요약
+  bool verbose = !app->continuous && !app->array_mode;
+
+  // ========== 트리거 타이밍 통계 ==========
+  app->timing_count++;
+  app->trigger_late_sum_ns += late_ns;
+  if (late_ns > app->trigger_late_max_ns)
+  {
+    app->trigger_late_max_ns = late_ns;
+  }
+  if (status == US_OK)
+  {
+    int64_t rise_lat_ns = s->rise_ns - s->trigger_ns;
+
+    if (app->rise_count == 0 || rise_lat_ns < app->rise_lat_min_ns)
     {
-      usleep(1);
-      if(++timeout_count > 30000) 
-      {
-        printf("Echo timeout (waiting for LOW)\n");
-        lcd_clear();
-        lcd_print("Timeout Error!");
-        lcd_set_cursor(1, 0);
-        lcd_print("Please retry");
-        sleep(2);
-        break;
-      }
+      app->rise_lat_min_ns = rise_lat_ns;
     }
-
-    if(timeout_count > 30000)
+    if (app->rise_count == 0 || rise_lat_ns > app->rise_lat_max_ns)
     {
-      ir_detected = false;
-      lcd_clear();
-      lcd_print("Waiting for");
-      lcd_set_cursor(1, 0);
-      lcd_print("IR Detection...");
-      continue;
+      app->rise_lat_max_ns = rise_lat_ns;
     }
+    app->rise_count++;
+  }
 
-    // ========== 에코 신호 종료 시간 기록 ==========
-    clock_gettime(CLOCK_MONOTONIC, &end);
+  app->measuring = false;
+  timer_disarm(app->echo_timer_fd);
+  app->measure_end_ns = monotonic_ns();
+  app->last_ping_ns = app->measure_end_ns;
 
-    // ========== 거리 계산 ==========
-    double time_sec = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
-    double distance = (time_sec * 34300.0) / 2.0;
+  // 결과 화면은 새 측정이 올 때까지, 또는 HOLD_NS 동안 유지
+  timer_arm_at(app->lcd_timer_fd, app->measure_end_ns + HOLD_NS);
 
-    // ========== 유효 범위 체크 ==========
-    if(distance >= 2.0 && distance <= 400.0) {
-    // ========== 측정 결과 출력 ==========
-    printf("측정 거리: %.2f cm\n", distance);
+  // 측정 도중 IR 이벤트가 들어왔으면 다음 측정 예약
+  if (app->pending)
+  {
+    schedule_measurement(app);
+  }
 
-    // ========== LCD에 거리 표시 ==========
-    lcd_clear();
-    lcd_printf(0, 0, "Dist: %.1fcm #%d", distance, num);
+  if (!verbose)
+  {
+    report_ranging(app, s);
+  }
 
-    // ========== LED 제어 ==========
-    if(distance < THRESHOLD) 
+  if (status != US_OK)
+  {
+    // 연속 측정은 요약의 유효 거리 비율로만 보임
+    if (verbose && status == US_TIMEOUT_HIGH)
     {
-      gpiod_line_set_value(led, 1);
-      printf("LED ON - 물체가 %.2f cm 이내에 있습니다!\n", THRESHOLD);
-      // LCD에 경고 표시
-      lcd_set_cursor(1, 0);
-      lcd_print("LED ON! CLOSE!");
+      printf("Echo timeout (waiting for HIGH)\n");
     }
-    else
+    else if (verbose && status == US_TIMEOUT_LOW)
     {
-      gpiod_line_set_value(led, 0);
-      printf("LED OFF - 안전 거리 (%.2f cm)\n", distance);
-      
-      // LCD에 안전 표시
-      lcd_set_cursor(1, 0);
-      lcd_print("LED OFF - Safe");
+      printf("Echo timeout (waiting for LOW)\n");
     }
-            
-    // ========== 데이터베이스에 저장 ==========
-    snprintf(sql, sizeof(sql), 
-    "INSERT INTO ultrasonic(measurement_num, distance, ir_triggered) "
-    "VALUES(%d, %.2f, %d);",
-    num, distance, ir_detected ? 1 : 0);
-            
-    rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
-    if (rc != SQLITE_OK)
+    else if (verbose)
     {
-      fprintf(stderr, "SQL error: %s\n", err_msg);
-      sqlite3_free(err_msg);
+      perror("Error reading echo");
     }
-            
-    // 측정 결과 2초간 표시
-    sleep(2);
+
+    if (app->array_mode)
+    {
+      app->array_last_cm[s->sensor_id] = -1.0;
+      show_nearest(app);
+      return;
     }
-    else
+    show_screen(app, LCD_SCREEN_TIMEOUT, 0.0, false);
+    return;
+  }
+
+  // ========== 거리 계산 ==========
+  // 최근 온도의 음속 계수를 곱하고 시프트만 함 (온도를 모르면 20C)
+  int temp_c = app->dht_mode ? dht11_cached_temp_c(&app->dht, SOUND_DEFAULT_TEMP_C)
+                             : SOUND_DEFAULT_TEMP_C;
+  double distance = sound_ns_to_01mm(s->pulse_ns, temp_c) * 0.01;
+  double spread = (s->spread_ns >= 0) ? sound_ns_to_01mm(s->spread_ns, temp_c) * 0.01 : -1.0;
+
+  // ========== 유효 범위 체크 ==========
+  if (distance < US_MIN_RANGE_CM || distance > US_MAX_RANGE_CM)
+  {
+    if (verbose)
     {
       printf("측정 범위 초과: %.2f cm\n", distance);
-            
-      // LCD에 에러 표시
-      lcd_clear();
-      lcd_print("Out of Range!");
-      lcd_set_cursor(1, 0);
-      lcd_printf(1, 0, "%.1f cm", distance);
-      sleep(2);
     }
 
-    // ========== 다음 측정 준비 ==========
-    ir_detected = false;
-        
-    // LCD 대기 화면으로 복귀
-    lcd_clear();
-    lcd_print("Waiting for");
-    lcd_set_cursor(1, 0);
-    lcd_print("IR Detection...");
-        
-    usleep(500000);
+    if (app->array_mode)
+    {
+      app->array_last_cm[s->sensor_id] = -1.0;
+      show_nearest(app);
+      return;
+    }
+    // LCD에 에러 표시
+    show_screen(app, LCD_SCREEN_OUT_OF_RANGE, distance, false);
+    return;
   }
 
-  // ========== 프로그램 종료 처리 ==========
-  printf("\n프로그램 종료 중...\n");
-    
-  // LCD 종료 메시지
-  lcd_clear();
-  lcd_print("System");
-  lcd_set_cursor(1, 0);
-  lcd_print("Shutting Down");
-  sleep(1);
-    
-  gpiod_line_set_value(led, 0);
-    
-  gpiod_line_release(trig);
-  gpiod_line_release(echo);
-  gpiod_line_release(ir);
-  gpiod_line_release(led);
-    
-  gpiod_chip_close(chip);
-  sqlite3_close(db);
-  lcd_close();
-    
-  printf("총 %d개의 IR 트리거 이벤트가 처리되었습니다.\n", num);
-
-  return 0;
-}
+  // ========== 측정 결과 출력 ==========
+  if (!verbose)
+  {
+    app->ranging_ok++;
+    app->ranging_last_cm = distance;
+    if (app->array_mode)
+    {
+      app->array_ok[s->sensor_id]++;
+    }
+  }
+  else if (app->burst_size > 1)
+  {
+    printf("측정 거리: %.2f cm (핑 %d/%d 중앙값, IQR %.2f cm, %d C 음속)\n",
+           distance, s->pings, app->burst_size, spread, temp_c);
+  }
+  else
+  {
+    printf("측정 거리: %.2f cm (%d C 음속)\n", distance, temp_c);
+  }
 
-// ========== LCD 초기화 함수 ==========
-int lcd_init(const char *i2c_device, int lcd_address)
-{
-  // I2C 디바이스 열기
-  i2c_fd = open(i2c_device, O_RDWR);
-  if (i2c_fd < 0) 
+  // ========== LED 제어 + LCD에 거리 표시 ==========
+  // 센서 배열은 센서별 최근 거리 중 가장 가까운 값으로 표시
+  if (app->array_mode)
+  {
+    app->array_last_cm[s->sensor_id] = distance;
+    show_nearest(app);
+  }
+  else if (distance < THRESHOLD) 
+  {
+    gpiod_line_set_value(app->led, 1);
+    if (verbose)
+    {
+      printf("LED ON - 물체가 %.2f cm 이내에 있습니다!\n", THRESHOLD);
+    }
+    // 렌더 스레드가 다음 프레임에 그림 (LED ON이면 경고, 아니면 안전 표시)
+    show_screen(app, LCD_SCREEN_RESULT, distance, true);
+  }
+  else
   {
-    perror("Failed to open I2C device");
-    return -1;
+    gpiod_line_set_value(app->led, 0);
+    if (verbose)
+    {
+      printf("LED OFF - 안전 거리 (%.2f cm)\n", distance);
+    }
+    show_screen(app, LCD_SCREEN_RESULT, distance, false);
   }
 
-  // I2C 슬레이브 주소 설정
-  if (ioctl(i2c_fd, I2C_SLAVE, lcd_address) < 0) 
+  // ========== 데이터베이스에 저장 ==========
+  // 쓰기 스레드의 링에 넣기만 함 (IR 트리거 측정은 IR 누적 횟수, 연속 측정/배열은 핑 번호)
+  struct sample record = *s;
+  if (verbose)
   {
-    perror("Failed to set I2C slave address");
-    close(i2c_fd);
-    i2c_fd = -1;
-    return -1;
+    record.num = app->num;
   }
+  record.distance_cm = distance;
+  record.spread_cm = spread;
+  db_writer_submit(&app->writer, &record);
+}
 
-  // LCD 초기화 시퀀스 (4비트 모드)
-  usleep(50000);  // 50ms 대기 (전원 안정화)
-    
-  // 8비트 모드로 3번 시도 (리셋)
-  lcd_write_nibble(0x03 << 4, 0);
-  usleep(4500);
-  lcd_write_nibble(0x03 << 4, 0);
-  usleep(4500);
-  lcd_write_nibble(0x03 << 4, 0);
-  usleep(150);
-    
-  // 4비트 모드로 전환
-  lcd_write_nibble(0x02 << 4, 0);
-  usleep(150);
-    
-  // Function Set: 4비트, 2줄, 5x8 폰트
-  lcd_command(LCD_FUNCTION_SET);
-  usleep(50);
-    
-  // Display ON/OFF Control: 디스플레이 켜기, 커서 끄기
-  lcd_command(LCD_DISPLAY_ON);
-  usleep(50);
-    
-  // Clear Display
-  lcd_command(LCD_CLEAR);
-  usleep(2000);  // 클리어 명령은 시간이 오래 걸림
-    
-  // Entry Mode Set: 커서 오른쪽 이동, 화면 이동 없음
-  lcd_command(LCD_ENTRY_MODE);
-  usleep(50);
+// ========== LCD 화면 상태 발행 ==========
+// 렌더 스레드의 우편함에 덮어쓰기만 하므로 I2C 속도와 무관하게 바로 돌아옴
+void show_screen(struct app *app, int screen, double distance, bool led_on)
+{
+  struct lcd_state state;
 
-  return 0;
+  state.screen = screen;
+  state.num = app->num;
+  state.led_on = led_on;
+  state.distance_cm = distance;
+  lcd_render_publish(&app->display, &state);
 }
 
-// ========== LCD 닫기 함수 ==========
-void lcd_close(void)
+// ========== 센서 배열: 가장 가까운 물체로 LED/LCD 갱신 ==========
+// 어느 센서도 유효 거리가 없으면 타임아웃 화면
+void show_nearest(struct app *app)
 {
-  if (i2c_fd >= 0)
+  double nearest = -1.0;
+
+  for (int i = 0; i < app->array.count; i++)
   {
-    lcd_clear();
-    close(i2c_fd);
-    i2c_fd = -1;
+    if (app->array_last_cm[i] >= 0 && (nearest < 0 || app->array_last_cm[i] < nearest))
+    {
+      nearest = app->array_last_cm[i];
+    }
   }
+
+  if (nearest < 0)
+  {
+    gpiod_line_set_value(app->led, 0);
+    show_screen(app, LCD_SCREEN_TIMEOUT, 0.0, false);
+    return;
+  }
+  gpiod_line_set_value(app->led, nearest < THRESHOLD);
+  show_screen(app, LCD_SCREEN_RESULT, nearest, nearest < THRESHOLD);
 }
 
-// ========== 4비트 쓰기 함수 (Low Level) ==========
-void lcd_write_nibble(unsigned char data, unsigned char mode)
+// ========== 연속 측정 1초 요약 ==========
+// 직전 구간의 핑 속도, 유효 거리 비율, 다음 핑 간격을 한 줄로 출력한 뒤 이번 핑을 셈
+// 센서 배열은 간격을 배열 스레드가 정하므로 슬롯 속도와 센서별 유효 비율을 출력
+void report_ranging(struct app *app, const struct sample *s)
 {
-  unsigned char byte = data | mode | LCD_BACKLIGHT;
-    
-  // Enable 신호로 데이터 전송
-  //반환값에 변수를 저장(경고 해결)
-  if(write(i2c_fd, &byte, 1) != 1)
+  int64_t now_ns = monotonic_ns();
+
+  if (app->ranging_report_ns == 0)
   {
-    perror("i2c write error");
+    app->ranging_report_ns = now_ns + RANGING_REPORT_NS;
   }
-  usleep(1);
-  
-  byte |= LCD_ENABLE;
-  if(write(i2c_fd, &byte, 1) != 1)
+  else if (now_ns >= app->ranging_report_ns)
   {
-    perror("i2c write error");
+    double window_s = (now_ns - app->ranging_report_ns + RANGING_REPORT_NS) / 1e9;
+
+    if (app->array_mode)
+    {
+      report_array(app, window_s);
+    }
+    else
+    {
+      printf("연속 측정 %.1f %s | 유효 %d/%d | 최근 %.2f cm | 다음 간격 %.1f ms\n",
+             app->ranging_count / window_s, app->burst_size > 1 ? "측정/s" : "pings/s",
+             app->ranging_ok, app->ranging_count,
+             app->ranging_last_cm, ping_interval_ns(s->status, s->pulse_ns) / 1e6);
+    }
+    app->ranging_count = 0;
+    app->ranging_ok = 0;
+    app->ranging_report_ns = now_ns + RANGING_REPORT_NS;
   }
-  usleep(1);
-    
-  byte &= ~LCD_ENABLE;
-  if(write(i2c_fd, &byte, 1) != 1)
+  app->ranging_count++;
+
+  // 한 슬롯에서 함께 쏜 센서의 결과는 트리거 시각이 같음
+  if (app->array_mode)
   {
-    perror("i2c write error");
+    if (s->trigger_ns != app->array_last_trigger_ns)
+    {
+      app->array_slots++;
+      app->array_last_trigger_ns = s->trigger_ns;
+    }
+    app->array_pings[s->sensor_id]++;
   }
-  usleep(50);
 }
 
-// ========== 8비트 쓰기 함수 ==========
-void lcd_write_byte(unsigned char data, unsigned char mode)
+// ========== 센서 배열 1초 요약 ==========
+// 슬롯 속도, 전체 핑 속도, 센서별 유효 거리 비율을 한 줄로 출력하고 구간 카운터를 비움
+void report_array(struct app *app, double window_s)
 {
-  // 상위 4비트 전송
-  lcd_write_nibble(data & 0xF0, mode);
-  // 하위 4비트 전송
-  lcd_write_nibble((data << 4) & 0xF0, mode);
+  printf("센서 배열 슬롯 %.1f/s | 전체 %.1f pings/s | 유효",
+         app->array_slots / window_s, app->ranging_count / window_s);
+  for (int i = 0; i < app->array.count; i++)
+  {
+    printf(" %d:%d/%d", i, app->array_ok[i], app->array_pings[i]);
+    app->array_pings[i] = 0;
+    app->array_ok[i] = 0;
+  }
+  printf(" | 최근 %.2f cm\n", app->ranging_last_cm);
+  app->array_slots = 0;
 }
 
-// ========== 명령 전송 함수 ==========
-void lcd_command(unsigned char cmd)
+// ========== IMU 샘플 묶음 (IMU 스레드에서 호출) ==========
+// 묶음째 자세 추정에 넘기고, 샘플마다 출력하지 않고 1초에 한 줄로 평균만 출력
+void on_imu_batch(const struct imu_batch *batch, void *arg)
 {
-  lcd_write_byte(cmd, 0);  // RS=0 (명령 모드)
-}
+  struct app *app = arg;
+  double roll, pitch;
 
-// ========== 데이터 전송 함수 ==========
-void lcd_data(unsigned char data)
-{
-  lcd_write_byte(data, LCD_RS);  // RS=1 (데이터 모드)
-}
+  imu_fusion_process(&app->fusion, batch);
 
-// ========== 화면 지우기 함수 ==========
-void lcd_clear(void)
-{
-  lcd_command(LCD_CLEAR);
-  usleep(2000);  // 클리어 명령은 시간이 오래 걸림
-}
+  for (int i = 0; i < batch->count; i++)
+  {
+    const struct imu_raw *r = &batch->samples[i];
 
-// ========== 커서 위치 설정 함수 ==========
-void lcd_set_cursor(int row, int col)
-{
-  // 16x2 LCD의 DDRAM 주소
-  // 첫 번째 줄: 0x00-0x0F
-  // 두 번째 줄: 0x40-0x4F
-  unsigned char address = (row == 0) ? 0x00 : 0x40;
-  address += col;
-  lcd_command(LCD_SET_DDRAM | address);
+    app->imu_sum[0] += r->ax;
+    app->imu_sum[1] += r->ay;
+    app->imu_sum[2] += r->az;
+    app->imu_sum[3] += r->gx;
+    app->imu_sum[4] += r->gy;
+    app->imu_sum[5] += r->gz;
+  }
+  app->imu_report_count += batch->count;
+
+  int64_t last_ns = batch->ts_ns[batch->count - 1];
+
+  if (app->imu_report_ns == 0)
+  {
+    app->imu_report_ns = last_ns + IMU_REPORT_NS;
+  }
+  if (last_ns < app->imu_report_ns)
+  {
+    return;
+  }
+
+  double n = app->imu_report_count;
+  imu_fusion_angles(&app->fusion, &roll, &pitch);
+  printf("IMU %d샘플 | 가속도 %6.3f %6.3f %6.3f g | 자이로 %7.2f %7.2f %7.2f dps"
+         " | roll %6.1f pitch %6.1f\n",
+         app->imu_report_count,
+         app->imu_sum[0] / n / MPU6050_ACCEL_LSB_PER_G,
+         app->imu_sum[1] / n / MPU6050_ACCEL_LSB_PER_G,
+         app->imu_sum[2] / n / MPU6050_ACCEL_LSB_PER_G,
+         app->imu_sum[3] / n / MPU6050_GYRO_LSB_PER_DPS,
+         app->imu_sum[4] / n / MPU6050_GYRO_LSB_PER_DPS,
+         app->imu_sum[5] / n / MPU6050_GYRO_LSB_PER_DPS, roll, pitch);
+
+  memset(app->imu_sum, 0, sizeof(app->imu_sum));
+  app->imu_report_count = 0;
+  app->imu_report_ns += IMU_REPORT_NS;
 }
 
-// ========== 문자열 출력 함수 ==========
-void lcd_print(const char *str)
+// ========== 트리거 타이밍 보고 ==========
+// 예약 → 실제 트리거 지연과, 트리거 → 에코 상승 타임스탬프의 흔들림(최대 - 최소)
+void print_timing_report(struct app *app)
 {
-  while (*str) 
+  if (app->timing_count == 0)
+  {
+    return;
+  }
+
+  printf("트리거 지연 (예약→실제): 최대 %.1f us, 평균 %.1f us\n",
+         app->trigger_late_max_ns / 1000.0,
+         app->trigger_late_sum_ns / 1000.0 / app->timing_count);
+
+  if (app->rise_count > 0)
+  {
+    printf("트리거→에코 상승 지터: %.1f us (최소 %.1f us, 최대 %.1f us)\n",
+           (app->rise_lat_max_ns - app->rise_lat_min_ns) / 1000.0,
+           app->rise_lat_min_ns / 1000.0, app->rise_lat_max_ns / 1000.0);
+  }
+
+  if (app->threaded)
   {
-    lcd_data(*str++);
+    printf("실시간 링 버퍼에서 버린 결과: %u개\n", sample_ring_dropped(&app->rt.ring));
   }
 }
 
-// ========== 포맷 문자열 출력 함수 (printf 스타일) ==========
-void lcd_printf(int row, int col, const char *format, ...)
+// ========== 사용법 출력 ==========
+void print_usage(const char *prog)
 {
-  char buffer[17];  // 16x2 LCD이므로 최대 16자 + NULL
-  va_list args;
-    
-  va_start(args, format);
-  vsnprintf(buffer, sizeof(buffer), format, args);
-  va_end(args);
-    
-  lcd_set_cursor(row, col);
-  lcd_print(buffer);
+  printf("사용법: %s [-r CPU] [-p 우선순위] [-b 행수] [-t 밀리초] [-s 동기화] [-C] [-P 디렉터리] [-W 초] [-Q MB] [-D 일] [-S 디렉터리] [-l] [-i Hz] [-m 핀] [-d 핀] [-c] [-k K] [-A 목록] [-g N] [-L 핀] [-B 핀] [-F]\n", prog);
+  printf("  -r CPU   실시간 측정 스레드 사용 (SCHED_FIFO, 지정 CPU에 고정, mlockall)\n");
+  printf("  -p N     실시간 스레드 SCHED_FIFO 우선순위 (기본 %d)\n", RT_DEFAULT_PRIORITY);
+  printf("  -b N     N행마다 한 트랜잭션으로 커밋 (WAL 저널, 1이면 행마다 커밋)\n");
+  printf("  -t MS    첫 행 이후 MS 밀리초가 지나면 커밋 (WAL 저널)\n");
+  printf("  -s LEVEL PRAGMA synchronous (OFF, NORMAL, FULL, EXTRA)\n");
+  printf("  -C       압축 스키마(samples: ns 키, WITHOUT ROWID, 0.1mm 정수)에 저장\n");
+  printf("  -P DIR   구간마다 DIR/%sYYYYMMDD-HHMM%s 파일에 나눠 저장 (UTC)\n",
+         PARTITION_PREFIX, PARTITION_SUFFIX);
+  printf("  -W SEC   파티션 구간 길이 (기본 %d초 = 하루)\n", PARTITION_DEFAULT_WINDOW_S);
+  printf("  -Q MB    파티션 전체 크기 예산, 넘으면 오래된 파일부터 삭제\n");
+  printf("  -D DAYS  파티션 보관 일수, 지난 파일은 삭제\n");
+  printf("  -S DIR   SQLite 대신 DIR/%s<생성 ns>%s mmap 세그먼트에 추가 (%u레코드마다 교체)\n",
+         SAMPLE_LOG_PREFIX, SAMPLE_LOG_SUFFIX, SAMPLE_LOG_DEFAULT_RECORDS);
+  printf("  -l       LCD busy flag 읽기 (읽을 수 없으면 고정 지연으로 대체)\n");
+  printf("  -i HZ    MPU6050 FIFO 수집 (최대 %d Hz, I2C 400kHz 권장)\n", MPU6050_MAX_RATE_HZ);
+  printf("  -m PIN   MPU6050 INT 핀 GPIO 번호 (data-ready 인터럽트로 수집)\n");
+  printf("  -c       연속 측정: IR 없이 가까운 물체일수록 짧은 간격으로 핑 (%.0f~%.0f ms)\n",
+         PING_MIN_INTERVAL_NS / 1e6, PING_MAX_INTERVAL_NS / 1e6);
+  printf("  -k K     버스트 측정: 측정마다 핑 K회(최대 %d)의 중앙값과 IQR 저장\n", BURST_MAX);
+  printf("  -A LIST  초음파 센서 배열 트리거:에코 쌍 목록 (최대 %d개, 예: 27:17,5:6,13:19)\n",
+         US_ARRAY_MAX);
+  printf("  -g N     센서 배열 그룹 수 (센서 i는 그룹 i %% N, 기본 %d, 이웃 센서는 다른 그룹)\n",
+         US_ARRAY_DEFAULT_GROUPS);
+  printf("  -L PIN   라인 트레이서 GPIO 번호 (양방향 에지, %d us 디바운스, 전이마다 출력)\n",
+         LINE_DEBOUNCE_US);
+  printf("  -B PIN   버튼 GPIO 번호 (내부 풀업, %d ms 디바운스, 누르면 결과 화면 닫기)\n",
+         BUTTON_DEBOUNCE_US / 1000);
+  printf("  -d PIN   DHT11 데이터 핀 GPIO 번호 (온도로 음속 보정, 없으면 %d C)\n",
+         SOUND_DEFAULT_TEMP_C);
+  printf("  -F       IMU 자세 추정 처리량 벤치마크 후 종료 (벡터/스칼라)\n");
 }
 
 // ========== 에러 체크 함수 ==========
@@ -563,23 +1326,17 @@ void check_error(int is_error, int error_code)
       case 7: perror("Error: Echo Input Mode Failed"); break;
       case 8: perror("Error: IR Interrupt Mode Failed"); break;
       case 9: perror("Error: LED Output Mode Failed"); break;
+      case 10: perror("Error: Event Loop Setup Failed"); break;
+      case 11: perror("Error: Real-time Thread Setup Failed"); break;
+      case 12: perror("Error: LCD Render Thread Failed"); break;
+      case 13: perror("Error: IMU Setup Failed"); break;
+      case 14: perror("Error: DHT11 Setup Failed"); break;
+      case 15: perror("Error: Ultrasonic Array Setup Failed"); break;
+      case 16: perror("Error: Input Line Setup Failed"); break;
       default: perror("Error: Unknown Error"); break;
     }
     
-    if (i2c_fd >= 0)
-    {
-      lcd_close();
-    }
+    lcd_close();
     exit(1);
   }
 }
-
-// ========== 시그널 핸들러 함수 ==========
-void signal_handler(int sig)
-{
-  if (sig == SIGINT)
-  {
-    printf("\n종료 신호를 받았습니다...\n");
-    running = false;
-  }
-}
\ No newline at end of file
@@ -0,0 +1,479 @@
+/*
+파일명: lcd.c
+작성일: 2026-10-16
+설명: I2C LCD 16x2 (HD44780 + PCF8574 백팩) 드라이버
+      ir_ultrasonic_sensor_lcd.c에서 분리
+      화면을 바꿀 때 lcd_clear(2ms 대기) 후 줄 전체를 다시 쓰는 대신
+      그림자 버퍼의 바뀐 칸만 보내고 커서 이동도 최소화
+      명령/문자열 하나의 니블+Enable 시퀀스를 버퍼에 모아 I2C 트랜잭션 한 번으로 전송
+      lcd_use_busy_flag(true)면 긴 명령 뒤에 고정 대기 대신 busy flag를 읽음
+      I2C는 공유 버스 관리자(i2c_bus)를 통해 낮은 우선순위로 전송
+ */
+
+#include <stdio.h>
+#include <stdarg.h>     // va_list (lcd_printf)
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "lcd.h"
+#include "event_loop.h"
+
+// ========== 드라이버 상태 ==========
+static struct i2c_dev lcd_dev;                   // 공유 버스 위의 LCD 장치
+static bool lcd_open = false;
+static unsigned char fb_want[LCD_ROWS][LCD_COLS]; // 그려야 할 화면
+static unsigned char fb_have[LCD_ROWS][LCD_COLS]; // LCD에 실제로 있는 화면
+static int cursor_row = -1;                      // LCD 커서 위치 (-1: 모름)
+static int cursor_col = 0;
+
+// 전송 버퍼: 니블마다 3바이트(설정, E=1, E=0)를 모았다가 한 트랜잭션으로 보냄
+// 화면 전체(32칸) + 커서 이동 2번 = 204바이트가 한 번에 들어가는 크기
+#define LCD_TX_MAX 256
+static unsigned char tx_buf[LCD_TX_MAX];
+static int tx_len = 0;
+static int tx_depth = 0;                         // tx_begin 중첩 깊이 (0이면 바로 전송)
+
+// 전송량 통계
+static unsigned long bytes_sent = 0;             // I2C로 보낸 바이트 수
+static unsigned long transfers = 0;              // I2C 트랜잭션 (ioctl) 횟수
+static unsigned long fb_flushes = 0;             // 내용이 바뀐 flush 횟수
+static unsigned long fb_flush_bytes = 0;         // 그 flush들이 보낸 바이트 수
+
+// 명령 완료 대기 (busy flag 또는 고정 지연)
+static bool busy_poll = false;                   // busy flag 읽기 사용 여부
+static unsigned long wait_count = 0;
+static unsigned long wait_polls = 0;             // busy flag 읽은 횟수
+static unsigned long wait_fallbacks = 0;         // 시간 대기로 대체한 횟수
+static int64_t wait_total_ns = 0;                // 실제로 기다린 시간 합
+static int64_t wait_fixed_ns = 0;                // 고정 지연이었다면 기다렸을 시간 합
+static int64_t wait_max_ns = 0;
+
+static void tx_begin(void);
+static void tx_end(void);
+static void tx_flush(void);
+static void lcd_wait_ready(int fixed_us);
+static int read_busy_flag(void);
+
+// ========== LCD 초기화 함수 ==========
+// bus는 이미 열린 공유 버스. 주소 전환 없이 전송마다 lcd_address로 보냄
+int lcd_init(struct i2c_bus *bus, int lcd_address)
+{
+  i2c_dev_init(&lcd_dev, bus, lcd_address, I2C_PRIO_DISPLAY, "lcd");
+  lcd_open = true;
+
+  // LCD 초기화 시퀀스 (4비트 모드)
+  usleep(50000);  // 50ms 대기 (전원 안정화)
+    
+  // 8비트 모드로 3번 시도 (리셋)
+  lcd_write_nibble(0x03 << 4, 0);
+  usleep(4500);
+  lcd_write_nibble(0x03 << 4, 0);
+  usleep(4500);
+  lcd_write_nibble(0x03 << 4, 0);
+  usleep(150);
+    
+  // 4비트 모드로 전환
+  lcd_write_nibble(0x02 << 4, 0);
+  usleep(150);
+    
+  // 여기까지는 인터페이스 길이가 정해지지 않아 busy flag를 읽을 수 없으므로 고정 대기
+  // 이후 명령은 lcd_wait_ready (busy flag 모드면 준비되는 즉시 진행)
+
+  // Function Set: 4비트, 2줄, 5x8 폰트
+  lcd_command(LCD_FUNCTION_SET);
+  lcd_wait_ready(50);
+    
+  // Display ON/OFF Control: 디스플레이 켜기, 커서 끄기
+  lcd_command(LCD_DISPLAY_ON);
+  lcd_wait_ready(50);
+    
+  // Clear Display
+  lcd_command(LCD_CLEAR);
+  lcd_wait_ready(2000);  // 클리어 명령은 시간이 오래 걸림
+    
+  // Entry Mode Set: 커서 오른쪽 이동, 화면 이동 없음
+  lcd_command(LCD_ENTRY_MODE);
+  lcd_wait_ready(50);
+
+  // 화면이 지워진 상태이므로 그림자 버퍼도 공백으로 맞춤
+  memset(fb_have, ' ', sizeof(fb_have));
+  memset(fb_want, ' ', sizeof(fb_want));
+  cursor_row = 0;
+  cursor_col = 0;
+
+  return 0;
+}
+
+// ========== LCD 닫기 함수 ==========
+void lcd_close(void)
+{
+  // 버스는 다른 장치도 쓰므로 닫지 않음 (i2c_bus_close는 소유자가 부름)
+  if (lcd_open)
+  {
+    lcd_clear();
+    tx_flush();
+    lcd_open = false;
+  }
+}
+
+// ========== 4비트 쓰기 함수 (Low Level) ==========
+// 바로 쓰지 않고 전송 버퍼에 추가. PCF8574는 받은 바이트마다 출력을 바꾸므로
+// 100kHz 버스에서 바이트 하나가 약 90us(400kHz: 약 22us) 걸려서
+// Enable 펄스 폭(450ns 이상)과 명령 실행 시간(37us)은 버스 클럭만으로 충족됨
+// (다음 니블의 E 하강까지 최소 2바이트가 지나감)
+// 1.52ms 걸리는 Clear/Home은 호출한 쪽에서 전송 후 usleep으로 기다림
+void lcd_write_nibble(unsigned char data, unsigned char mode)
+{
+  unsigned char byte = data | mode | LCD_BACKLIGHT;
+
+  if (tx_len + 3 > LCD_TX_MAX)
+  {
+    tx_flush();
+  }
+
+  tx_buf[tx_len++] = byte;                  // 데이터/RS 설정
+  tx_buf[tx_len++] = byte | LCD_ENABLE;     // E 상승
+  tx_buf[tx_len++] = byte & ~LCD_ENABLE;    // E 하강 (이때 LCD가 읽음)
+
+  if (tx_depth == 0)
+  {
+    tx_flush();
+  }
+}
+
+// ========== 8비트 쓰기 함수 ==========
+void lcd_write_byte(unsigned char data, unsigned char mode)
+{
+  tx_begin();
+  // 상위 4비트 전송
+  lcd_write_nibble(data & 0xF0, mode);
+  // 하위 4비트 전송
+  lcd_write_nibble((data << 4) & 0xF0, mode);
+  tx_end();
+}
+
+// ========== 명령 전송 함수 ==========
+void lcd_command(unsigned char cmd)
+{
+  lcd_write_byte(cmd, 0);  // RS=0 (명령 모드)
+}
+
+// ========== 데이터 전송 함수 ==========
+void lcd_data(unsigned char data)
+{
+  lcd_write_byte(data, LCD_RS);  // RS=1 (데이터 모드)
+
+  // 커서 위치의 칸이 바뀌었음을 그림자 버퍼에 기록 (커서는 오른쪽으로 한 칸)
+  if (cursor_row >= 0 && cursor_col < LCD_COLS)
+  {
+    fb_have[cursor_row][cursor_col] = data;
+  }
+  cursor_col++;
+}
+
+// ========== 화면 지우기 함수 ==========
+void lcd_clear(void)
+{
+  lcd_command(LCD_CLEAR);
+  lcd_wait_ready(2000);  // 클리어 명령은 시간이 오래 걸림 (묶음 중이어도 먼저 보냄)
+
+  memset(fb_have, ' ', sizeof(fb_have));
+  cursor_row = 0;
+  cursor_col = 0;
+}
+
+// ========== 커서 위치 설정 함수 ==========
+void lcd_set_cursor(int row, int col)
+{
+  // 16x2 LCD의 DDRAM 주소
+  // 첫 번째 줄: 0x00-0x0F
+  // 두 번째 줄: 0x40-0x4F
+  unsigned char address = (row == 0) ? 0x00 : 0x40;
+  address += col;
+  lcd_command(LCD_SET_DDRAM | address);
+
+  cursor_row = (row == 0) ? 0 : 1;
+  cursor_col = col;
+}
+
+// ========== 문자열 출력 함수 ==========
+void lcd_print(const char *str)
+{
+  tx_begin();
+  while (*str) 
+  {
+    lcd_data(*str++);
+  }
+  tx_end();
+}
+
+// ========== 포맷 문자열 출력 함수 (printf 스타일) ==========
+void lcd_printf(int row, int col, const char *format, ...)
+{
+  char buffer[17];  // 16x2 LCD이므로 최대 16자 + NULL
+  va_list args;
+    
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+    
+  tx_begin();
+  lcd_set_cursor(row, col);
+  lcd_print(buffer);
+  tx_end();
+}
+
+// ========== 그림자 버퍼 지우기 (전송 없음) ==========
+void lcd_fb_clear(void)
+{
+  memset(fb_want, ' ', sizeof(fb_want));
+}
+
+// ========== 그림자 버퍼에 문자열 쓰기 (전송 없음) ==========
+// 화면 밖으로 넘치는 글자는 잘림
+void lcd_fb_print(int row, int col, const char *str)
+{
+  if (row < 0 || row >= LCD_ROWS)
+  {
+    return;
+  }
+
+  while (*str && col < LCD_COLS)
+  {
+    if (col >= 0)
+    {
+      fb_want[row][col] = (unsigned char)*str;
+    }
+    str++;
+    col++;
+  }
+}
+
+// ========== 그림자 버퍼에 포맷 문자열 쓰기 ==========
+void lcd_fb_printf(int row, int col, const char *format, ...)
+{
+  char buffer[LCD_COLS + 1];
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+
+  lcd_fb_print(row, col, buffer);
+}
+
+// ========== 바뀐 칸만 전송 ==========
+// 다음 바뀐 칸까지 사이의 안 바뀐 칸이 1개 이하면 그냥 덮어쓰고(1바이트),
+// 그보다 멀거나 다른 줄이면 커서 이동 명령(1바이트)을 씀
+// 반환값: 이번에 보낸 I2C 바이트 수
+int lcd_fb_flush(void)
+{
+  unsigned long start_bytes = bytes_sent;
+
+  tx_begin();
+  for (int row = 0; row < LCD_ROWS; row++)
+  {
+    for (int col = 0; col < LCD_COLS; col++)
+    {
+      if (fb_want[row][col] == fb_have[row][col])
+      {
+        continue;
+      }
+
+      if (cursor_row == row && cursor_col < col && col - cursor_col <= 1)
+      {
+        // 사이 칸을 그대로 다시 씀 (커서 이동 명령과 같은 비용)
+        while (cursor_col < col)
+        {
+          lcd_data(fb_have[row][cursor_col]);
+        }
+      }
+      else if (cursor_row != row || cursor_col != col)
+      {
+        lcd_set_cursor(row, col);
+      }
+
+      lcd_data(fb_want[row][col]);
+    }
+  }
+  tx_end();
+
+  if (bytes_sent != start_bytes)
+  {
+    fb_flushes++;
+    fb_flush_bytes += bytes_sent - start_bytes;
+  }
+  return (int)(bytes_sent - start_bytes);
+}
+
+// ========== 두 줄 화면 출력 함수 ==========
+// 그림자 버퍼에 두 줄을 그리고 바뀐 칸만 전송
+void lcd_show(const char *line1, const char *line2)
+{
+  lcd_fb_clear();
+  lcd_fb_print(0, 0, line1);
+  lcd_fb_print(1, 0, line2);
+  lcd_fb_flush();
+}
+
+// ========== 누적 I2C 전송 바이트 수 ==========
+unsigned long lcd_bytes_sent(void)
+{
+  return bytes_sent;
+}
+
+// ========== busy flag 모드 선택 ==========
+// lcd_init 전에 부름. RW 핀이 GND에 묶인 백팩이면 첫 대기에서 시간 초과로
+// 고정 지연으로 돌아감
+void lcd_use_busy_flag(bool enable)
+{
+  busy_poll = enable;
+}
+
+// ========== 누적 I2C 트랜잭션 수 ==========
+unsigned long lcd_transfers(void)
+{
+  return transfers;
+}
+
+// ========== 전송량 통계 출력 ==========
+void lcd_print_stats(void)
+{
+  if (fb_flushes == 0)
+  {
+    return;
+  }
+
+  printf("LCD 갱신: %lu회, 갱신당 평균 %.1f 바이트 (I2C 총 %lu 바이트, 트랜잭션 %lu회)\n",
+         fb_flushes, (double)fb_flush_bytes / fb_flushes, bytes_sent,
+         transfers);
+
+  if (wait_count > 0)
+  {
+    printf("LCD 명령 대기: %lu회, 평균 %.1f us, 최대 %.1f us, 고정 지연 대비 %.0f%% "
+           "(%s, busy flag 읽기 %lu회, 시간 대기 대체 %lu회)\n",
+           wait_count, wait_total_ns / 1000.0 / wait_count, wait_max_ns / 1000.0,
+           100.0 * wait_total_ns / wait_fixed_ns,
+           busy_poll ? "busy flag" : "고정 지연", wait_polls, wait_fallbacks);
+  }
+}
+
+// ========== 전송 묶음 시작/끝 ==========
+// 가장 바깥 tx_end에서 모인 바이트를 한 번에 보냄
+static void tx_begin(void)
+{
+  tx_depth++;
+}
+
+static void tx_end(void)
+{
+  if (--tx_depth == 0)
+  {
+    tx_flush();
+  }
+}
+
+// ========== 전송 버퍼를 I2C 쓰기 한 번으로 전송 ==========
+// START + 주소 + 데이터 N바이트 + STOP 한 트랜잭션 (I2C_RDWR 메시지 하나)
+static void tx_flush(void)
+{
+  if (tx_len == 0)
+  {
+    return;
+  }
+
+  if (i2c_dev_write(&lcd_dev, tx_buf, tx_len) < 0)
+  {
+    perror("i2c write error");
+  }
+  bytes_sent += tx_len;
+  transfers++;
+  tx_len = 0;
+}
+
+// ========== 명령 완료 대기 ==========
+// 보낼 것을 먼저 보낸 뒤, busy flag 모드면 BF가 0이 될 때까지 읽고
+// 아니면 fixed_us만큼 잠. 데이터시트 최대 실행 시간(fixed_us)이 지나도
+// busy면 BF를 읽을 수 없는 배선으로 보고 고정 지연으로 전환
+static void lcd_wait_ready(int fixed_us)
+{
+  int64_t start_ns, elapsed_ns;
+
+  tx_flush();
+  start_ns = monotonic_ns();
+
+  if (busy_poll)
+  {
+    int64_t deadline_ns = start_ns + fixed_us * 1000LL;
+    int busy;
+
+    while ((busy = read_busy_flag()) == 1 && monotonic_ns() < deadline_ns)
+    {
+    }
+    // 읽기 뒤 남은 E 하강 + 하위 니블 클럭 전송
+    tx_flush();
+
+    if (busy != 0)
+    {
+      int64_t left_ns = deadline_ns - monotonic_ns();
+
+      if (left_ns > 0)
+      {
+        usleep((left_ns + 999) / 1000);
+      }
+      fprintf(stderr, "LCD busy flag를 읽을 수 없어 고정 지연으로 전환\n");
+      busy_poll = false;
+      wait_fallbacks++;
+    }
+  }
+  else
+  {
+    usleep(fixed_us);
+  }
+
+  elapsed_ns = monotonic_ns() - start_ns;
+  wait_count++;
+  wait_total_ns += elapsed_ns;
+  wait_fixed_ns += fixed_us * 1000LL;
+  if (elapsed_ns > wait_max_ns)
+  {
+    wait_max_ns = elapsed_ns;
+  }
+}
+
+// ========== busy flag 읽기 ==========
+// RS=0, RW=1로 D4~D7을 1로 두면(PCF8574 준양방향 입력) E가 high인 동안
+// LCD가 상위 니블을 내보냄. D7이 BF. 하위 니블도 E 펄스로 넘겨야 하며
+// 그 세 바이트는 전송 버퍼에 남겨 다음 읽기(또는 tx_flush)와 함께 보냄
+// 쓰기와 읽기는 반복 START로 이어진 한 트랜잭션
+// 반환값: 1 busy, 0 준비됨, -1 I2C 에러
+static int read_busy_flag(void)
+{
+  unsigned char in_byte = 0xF0 | LCD_RW | LCD_BACKLIGHT;
+  unsigned char status;
+  int ret;
+
+  if (tx_len + 2 > LCD_TX_MAX)
+  {
+    tx_flush();
+  }
+  tx_buf[tx_len++] = in_byte;
+  tx_buf[tx_len++] = in_byte | LCD_ENABLE;   // E 상승 → 상위 니블 출력
+
+  ret = i2c_dev_write_read(&lcd_dev, tx_buf, tx_len, &status, 1);
+  bytes_sent += tx_len;
+  transfers++;
+  tx_len = 0;
+  if (ret < 0)
+  {
+    perror("i2c read error");
+    return -1;
+  }
+  wait_polls++;
+
+  tx_buf[tx_len++] = in_byte;                // E 하강
+  tx_buf[tx_len++] = in_byte | LCD_ENABLE;   // 하위 니블 (버림)
+  tx_buf[tx_len++] = in_byte;
+  return (status & 0x80) ? 1 : 0;
+}
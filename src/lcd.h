@@ -0,0 +1,60 @@
+/*
+파일명: lcd.h
+작성일: 2026-10-16
+설명: I2C LCD 16x2 (HD44780 + PCF8574 백팩) 드라이버
+      화면 그림자 버퍼(framebuffer)에 그린 뒤 바뀐 칸만 전송
+      명령/문자열/flush 하나는 I2C 트랜잭션 한 번으로 전송 (공유 버스 i2c_bus)
+ */
+
+#ifndef LCD_H
+#define LCD_H
+
+#include <stdbool.h>
+#include "i2c_bus.h"
+
+// ========== LCD 관련 상수 정의 ==========
+#define LCD_ADDR 0x27       // I2C LCD 주소 (일반적으로 0x27 또는 0x3F)
+#define LCD_BACKLIGHT 0x08  // 백라이트 비트
+#define LCD_ENABLE 0x04     // Enable 비트
+#define LCD_RW 0x02         // Read/Write 비트 (0=쓰기)
+#define LCD_RS 0x01         // Register Select 비트 (0=명령, 1=데이터)
+
+// LCD 명령어
+#define LCD_CLEAR 0x01      // 화면 지우기
+#define LCD_HOME 0x02       // 커서 홈으로
+#define LCD_ENTRY_MODE 0x06 // Entry mode: 커서 오른쪽 이동
+#define LCD_DISPLAY_ON 0x0C // 디스플레이 켜기, 커서 끄기
+#define LCD_FUNCTION_SET 0x28 // 4비트 모드, 2줄, 5x8 폰트
+#define LCD_SET_DDRAM 0x80  // DDRAM 주소 설정
+
+// 화면 크기
+#define LCD_ROWS 2
+#define LCD_COLS 16
+
+// ========== 기본 함수 (바로 전송) ==========
+void lcd_use_busy_flag(bool enable);
+int lcd_init(struct i2c_bus *bus, int lcd_address);
+void lcd_close(void);
+void lcd_write_nibble(unsigned char data, unsigned char mode);
+void lcd_write_byte(unsigned char data, unsigned char mode);
+void lcd_command(unsigned char cmd);
+void lcd_data(unsigned char data);
+void lcd_clear(void);
+void lcd_set_cursor(int row, int col);
+void lcd_print(const char *str);
+void lcd_printf(int row, int col, const char *format, ...);
+
+// ========== 그림자 버퍼 함수 ==========
+// lcd_fb_*로 그린 내용은 lcd_fb_flush를 불러야 화면에 반영됨
+void lcd_fb_clear(void);
+void lcd_fb_print(int row, int col, const char *str);
+void lcd_fb_printf(int row, int col, const char *format, ...);
+int lcd_fb_flush(void);
+void lcd_show(const char *line1, const char *line2);
+
+// ========== 전송량 통계 ==========
+unsigned long lcd_bytes_sent(void);
+unsigned long lcd_transfers(void);
+void lcd_print_stats(void);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+파일명: lcd_check.c
+작성일: 2026-10-16
+설명: LCD 전송 묶음 검증 (make check)
+      ioctl을 가짜로 바꿔 I2C_RDWR 호출 수와 쓴 바이트 수를 셈
+      16자 lcd_printf 하나가 트랜잭션 한 번인지,
+      바뀐 것이 없는 화면의 lcd_fb_flush가 0바이트인지 확인
+      I2C 어댑터 없이 실행 (버스 fd는 /dev/null)
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include "lcd.h"
+
+static int failures = 0;
+static unsigned long fake_calls = 0;   // I2C_RDWR ioctl 호출 수
+static unsigned long fake_bytes = 0;   // 그 호출들의 쓰기 메시지 바이트 합
+
+// ========== 가짜 ioctl (i2c_bus.o가 부르는 libc ioctl 대신) ==========
+// 읽기 메시지는 0으로 채움 (busy flag를 쓰지 않으므로 불리지 않음)
+int ioctl(int fd, unsigned long request, ...)
+{
+  struct i2c_rdwr_ioctl_data *data;
+  va_list args;
+  (void)fd;
+
+  if (request != I2C_RDWR)
+  {
+    return -1;
+  }
+
+  va_start(args, request);
+  data = va_arg(args, struct i2c_rdwr_ioctl_data *);
+  va_end(args);
+
+  fake_calls++;
+  for (unsigned i = 0; i < data->nmsgs; i++)
+  {
+    if (data->msgs[i].flags & I2C_M_RD)
+    {
+      for (int j = 0; j < data->msgs[i].len; j++)
+      {
+        data->msgs[i].buf[j] = 0;
+      }
+    }
+    else
+    {
+      fake_bytes += data->msgs[i].len;
+    }
+  }
+  return (int)data->nmsgs;
+}
+
+// ========== 결과 비교 ==========
+static void expect(const char *name, unsigned long calls, unsigned long want_calls,
+                   unsigned long bytes, unsigned long want_bytes)
+{
+  bool ok = (calls == want_calls) && (bytes == want_bytes);
+
+  printf("%-28s 전송 %lu회, %lu바이트  %s\n", name, calls, bytes, ok ? "통과" : "실패");
+  if (!ok)
+  {
+    failures++;
+  }
+}
+
+int main(void)
+{
+  struct i2c_bus bus;
+  unsigned long calls, bytes;
+  int flushed;
+
+  if (i2c_bus_open(&bus, "/dev/null") < 0)
+  {
+    return 1;
+  }
+  lcd_init(&bus, LCD_ADDR);
+
+  // 커서 이동 명령 1개 + 글자 16개, 각각 니블 2개 x 3바이트
+  calls = fake_calls;
+  bytes = fake_bytes;
+  lcd_printf(0, 0, "%s", "0123456789ABCDEF");
+  expect("16자 lcd_printf", fake_calls - calls, 1, fake_bytes - bytes, 17 * 6);
+
+  // 그림자 버퍼를 화면과 맞춘 뒤 같은 내용을 다시 flush
+  lcd_fb_clear();
+  lcd_fb_print(0, 0, "0123456789ABCDEF");
+  lcd_fb_print(1, 0, "dist  42.0 cm");
+  lcd_fb_flush();
+
+  calls = fake_calls;
+  bytes = fake_bytes;
+  flushed = lcd_fb_flush();
+  expect("안 바뀐 화면 lcd_fb_flush", fake_calls - calls, 0, fake_bytes - bytes, 0);
+  if (flushed != 0)
+  {
+    printf("lcd_fb_flush 반환값 %d  실패\n", flushed);
+    failures++;
+  }
+
+  // 한 칸만 바뀌면 커서 이동 + 글자 하나를 트랜잭션 한 번으로
+  calls = fake_calls;
+  bytes = fake_bytes;
+  lcd_fb_print(1, 9, "3");
+  lcd_fb_flush();
+  expect("한 칸 바뀐 lcd_fb_flush", fake_calls - calls, 1, fake_bytes - bytes, 2 * 6);
+
+  i2c_bus_close(&bus);
+
+  if (failures > 0)
+  {
+    printf("실패 %d건\n", failures);
+    return 1;
+  }
+  printf("통과\n");
+  return 0;
+}
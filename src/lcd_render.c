@@ -0,0 +1,196 @@
+/*
+파일명: lcd_render.c
+작성일: 2026-10-16
+설명: LCD 전용 렌더 스레드
+      I2C 버스가 느리거나 막혀도 측정 루프는 기다리지 않음
+      프레임 사이에 여러 번 발행된 상태는 마지막 것만 그려짐
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include "lcd.h"
+#include "lcd_render.h"
+#include "event_loop.h"
+
+static void *render_thread(void *arg);
+static bool read_state(struct lcd_render *r, struct lcd_state *out, uint32_t *seq);
+static void draw(const struct lcd_state *state);
+
+// ========== 스레드 시작 ==========
+// 시작 후에는 lcd_* 함수를 이 스레드만 부름 (lcd_render_stop 전까지)
+int lcd_render_start(struct lcd_render *r, int fps)
+{
+  pthread_attr_t attr;
+  int ret;
+
+  if (fps <= 0)
+  {
+    fps = LCD_RENDER_DEFAULT_FPS;
+  }
+  r->frame_ns = 1000000000LL / fps;
+  atomic_init(&r->stop, false);
+  atomic_init(&r->seq, 0);
+  atomic_init(&r->screen, LCD_SCREEN_WAITING);
+  atomic_init(&r->num, 0);
+  atomic_init(&r->led_on, false);
+  atomic_init(&r->distance_cm, 0.0);
+  r->published = 0;
+  r->frames = 0;
+  r->retries = 0;
+  r->render_total_ns = 0;
+  r->render_max_ns = 0;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, LCD_RENDER_STACK_SIZE);
+  ret = pthread_create(&r->thread, &attr, render_thread, r);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("pthread_create (lcd render)");
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 화면 상태 발행 (측정 루프) ==========
+// 시스템 콜도 잠금도 없이 원자적 저장 몇 번으로 끝남. 이전 값은 덮어씀
+void lcd_render_publish(struct lcd_render *r, const struct lcd_state *state)
+{
+  uint32_t seq = atomic_load_explicit(&r->seq, memory_order_relaxed);
+
+  atomic_store_explicit(&r->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  atomic_store_explicit(&r->screen, state->screen, memory_order_relaxed);
+  atomic_store_explicit(&r->num, state->num, memory_order_relaxed);
+  atomic_store_explicit(&r->led_on, state->led_on, memory_order_relaxed);
+  atomic_store_explicit(&r->distance_cm, state->distance_cm, memory_order_relaxed);
+
+  atomic_store_explicit(&r->seq, seq + 2, memory_order_release);
+  r->published++;
+}
+
+// ========== 스레드 종료 ==========
+// 마지막으로 발행된 상태를 그린 뒤 끝남
+void lcd_render_stop(struct lcd_render *r)
+{
+  atomic_store(&r->stop, true);
+  pthread_join(r->thread, NULL);
+}
+
+// ========== 렌더 통계 출력 ==========
+void lcd_render_print_stats(const struct lcd_render *r)
+{
+  if (r->frames == 0)
+  {
+    return;
+  }
+
+  printf("LCD 렌더: 발행 %llu회, 그린 프레임 %llu회 (%.0f fps 상한), "
+         "프레임당 평균 %.1f us, 최대 %.1f us, seqlock 재시도 %llu회\n",
+         (unsigned long long)r->published, (unsigned long long)r->frames,
+         1e9 / r->frame_ns, r->render_total_ns / 1000.0 / r->frames,
+         r->render_max_ns / 1000.0, (unsigned long long)r->retries);
+}
+
+// ========== 렌더 스레드 본체 ==========
+// 프레임 간격마다 깨어나 seq가 바뀌었을 때만 그림 (절대 시각으로 자므로 밀리지 않음)
+static void *render_thread(void *arg)
+{
+  struct lcd_render *r = arg;
+  struct lcd_state state;
+  struct timespec next;
+  uint32_t drawn_seq = 0;
+  uint32_t seq;
+  bool stopping = false;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (!stopping)
+  {
+    next.tv_nsec += r->frame_ns;
+    while (next.tv_nsec >= 1000000000L)
+    {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+    {
+    }
+
+    stopping = atomic_load(&r->stop);
+    if (read_state(r, &state, &seq) && seq != drawn_seq)
+    {
+      int64_t start_ns = monotonic_ns();
+      int64_t elapsed_ns;
+
+      draw(&state);
+      drawn_seq = seq;
+
+      elapsed_ns = monotonic_ns() - start_ns;
+      r->frames++;
+      r->render_total_ns += elapsed_ns;
+      if (elapsed_ns > r->render_max_ns)
+      {
+        r->render_max_ns = elapsed_ns;
+      }
+    }
+  }
+  return NULL;
+}
+
+// ========== 우편함 읽기 (seqlock) ==========
+// 쓰는 도중이면 몇 번 다시 읽고, 그래도 안 되면 이번 프레임은 건너뜀
+static bool read_state(struct lcd_render *r, struct lcd_state *out, uint32_t *seq)
+{
+  for (int tries = 0; tries < 4; tries++)
+  {
+    uint32_t before = atomic_load_explicit(&r->seq, memory_order_acquire);
+
+    out->screen = atomic_load_explicit(&r->screen, memory_order_relaxed);
+    out->num = atomic_load_explicit(&r->num, memory_order_relaxed);
+    out->led_on = atomic_load_explicit(&r->led_on, memory_order_relaxed);
+    out->distance_cm = atomic_load_explicit(&r->distance_cm, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if ((before & 1) == 0 &&
+        atomic_load_explicit(&r->seq, memory_order_relaxed) == before)
+    {
+      *seq = before;
+      return true;
+    }
+    r->retries++;
+  }
+  return false;
+}
+
+// ========== 상태를 화면으로 ==========
+// 그림자 버퍼에 그리고 바뀐 칸만 전송
+static void draw(const struct lcd_state *state)
+{
+  lcd_fb_clear();
+
+  switch (state->screen)
+  {
+    case LCD_SCREEN_RESULT:
+      lcd_fb_printf(0, 0, "Dist: %.1fcm #%d", state->distance_cm, state->num);
+      lcd_fb_print(1, 0, state->led_on ? "LED ON! CLOSE!" : "LED OFF - Safe");
+      break;
+    case LCD_SCREEN_OUT_OF_RANGE:
+      lcd_fb_print(0, 0, "Out of Range!");
+      lcd_fb_printf(1, 0, "%.1f cm", state->distance_cm);
+      break;
+    case LCD_SCREEN_TIMEOUT:
+      lcd_fb_print(0, 0, "Timeout Error!");
+      lcd_fb_print(1, 0, "Please retry");
+      break;
+    default:
+      lcd_fb_print(0, 0, "Waiting for");
+      lcd_fb_print(1, 0, "IR Detection...");
+      break;
+  }
+
+  lcd_fb_flush();
+}
@@ -0,0 +1,66 @@
+/*
+파일명: lcd_render.h
+작성일: 2026-10-16
+설명: LCD 전용 렌더 스레드
+      측정 루프는 화면 상태(작은 구조체)를 우편함에 덮어쓰기만 하고 바로 돌아옴
+      렌더 스레드가 정해진 프레임 간격마다 가장 최근 상태만 그려서 전송
+ */
+
+#ifndef LCD_RENDER_H
+#define LCD_RENDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define LCD_RENDER_DEFAULT_FPS 10   // 최대 초당 화면 갱신 수
+#define LCD_RENDER_STACK_SIZE (64 * 1024)   // 렌더 스레드 스택
+
+// ========== 표시할 화면 종류 ==========
+enum lcd_screen
+{
+  LCD_SCREEN_WAITING = 0,    // IR 감지 대기
+  LCD_SCREEN_RESULT,         // 측정 거리 + LED 상태
+  LCD_SCREEN_OUT_OF_RANGE,   // 유효 범위 밖
+  LCD_SCREEN_TIMEOUT         // 에코 타임아웃
+};
+
+// ========== 측정 루프가 넘기는 화면 상태 ==========
+struct lcd_state
+{
+  int32_t screen;        // enum lcd_screen
+  int32_t num;           // 측정 번호
+  bool led_on;           // 가까운 물체 경고
+  double distance_cm;
+};
+
+// ========== 렌더 스레드 ==========
+// 우편함은 seqlock: 쓰는 쪽이 seq를 홀수로 만들고 값을 쓴 뒤 짝수로 되돌림
+// 읽는 쪽은 seq가 짝수이고 읽기 전후로 같을 때만 그 값을 씀 (아니면 다시 읽음)
+struct lcd_render
+{
+  pthread_t thread;
+  int64_t frame_ns;                 // 프레임 간격 (갱신 상한)
+  _Atomic bool stop;
+
+  _Alignas(64) _Atomic uint32_t seq;
+  _Atomic int32_t screen;
+  _Atomic int32_t num;
+  _Atomic bool led_on;
+  _Atomic double distance_cm;
+
+  // 통계: published는 측정 루프, 나머지는 렌더 스레드만 씀 (종료 후 읽기)
+  _Alignas(64) uint64_t published;
+  uint64_t frames;                  // 실제로 그린 프레임 수
+  uint64_t retries;                 // 쓰는 도중이라 다시 읽은 횟수
+  int64_t render_total_ns;
+  int64_t render_max_ns;
+};
+
+int lcd_render_start(struct lcd_render *r, int fps);
+void lcd_render_publish(struct lcd_render *r, const struct lcd_state *state);
+void lcd_render_stop(struct lcd_render *r);
+void lcd_render_print_stats(const struct lcd_render *r);
+
+#endif
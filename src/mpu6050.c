@@ -0,0 +1,184 @@
+/*
+파일명: mpu6050.c
+작성일: 2026-10-16
+설명: MPU6050 (GY-521) 가속도/자이로 센서 드라이버
+      lab/mpu6050_test.c처럼 레지스터 쓰기 → usleep → 14바이트 읽기를 매번
+      하는 대신, FIFO 개수와 FIFO 내용을 쓰기+읽기 한 트랜잭션(I2C_RDWR)으로 읽음
+      1kHz × 12바이트 = 초당 12KB이므로 I2C 버스는 400kHz로 설정해야 여유가 있음
+ */
+
+#include <stdio.h>
+#include "mpu6050.h"
+
+#define FIFO_READ_MAX_FRAMES 80   // 한 번에 읽는 최대 프레임 (960바이트)
+
+static int write_reg(struct mpu6050 *imu, uint8_t reg, uint8_t value);
+static int read_regs(struct mpu6050 *imu, uint8_t reg, uint8_t *buf, int len);
+
+// ========== 초기화 ==========
+// 깨우기, 필터/범위/분주기 설정 후 가속도+자이로를 FIFO에 쌓기 시작
+int mpu6050_init(struct mpu6050 *imu, struct i2c_bus *bus, uint16_t addr, int rate_hz)
+{
+  uint8_t who = 0;
+  int div;
+
+  imu->overflows = 0;
+  i2c_dev_init(&imu->dev, bus, addr, I2C_PRIO_SENSOR, "mpu6050");
+
+  // 샘플레이트 = 1kHz / (1 + SMPLRT_DIV), 분주기는 0~255
+  if (rate_hz <= 0 || rate_hz > MPU6050_MAX_RATE_HZ)
+  {
+    rate_hz = MPU6050_MAX_RATE_HZ;
+  }
+  div = MPU6050_MAX_RATE_HZ / rate_hz - 1;
+  if (div > 255)
+  {
+    div = 255;
+  }
+  imu->rate_hz = MPU6050_MAX_RATE_HZ / (1 + div);
+
+  if (read_regs(imu, MPU6050_WHO_AM_I, &who, 1) < 0)
+  {
+    perror("MPU6050 WHO_AM_I read failed");
+    return -1;
+  }
+  if ((who & 0x7E) != 0x68)
+  {
+    fprintf(stderr, "MPU6050이 아님 (WHO_AM_I = 0x%02x)\n", who);
+    return -1;
+  }
+
+  if (write_reg(imu, MPU6050_PWR_MGMT_1, 0x01) < 0 ||      // 깨우기, 자이로 X PLL 클럭
+      write_reg(imu, MPU6050_CONFIG, 0x01) < 0 ||          // DLPF 184Hz → 자이로 출력 1kHz
+      write_reg(imu, MPU6050_SMPLRT_DIV, (uint8_t)div) < 0 ||
+      write_reg(imu, MPU6050_GYRO_CONFIG, 0x00) < 0 ||     // ±250 °/s
+      write_reg(imu, MPU6050_ACCEL_CONFIG, 0x00) < 0 ||    // ±2g
+      write_reg(imu, MPU6050_FIFO_EN, MPU6050_FIFO_EN_ACCEL_GYRO) < 0 ||
+      mpu6050_fifo_reset(imu) < 0)
+  {
+    perror("MPU6050 setup failed");
+    return -1;
+  }
+
+  return 0;
+}
+
+// ========== FIFO 비우고 다시 시작 ==========
+int mpu6050_fifo_reset(struct mpu6050 *imu)
+{
+  uint8_t status;
+
+  if (write_reg(imu, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET) < 0 ||
+      write_reg(imu, MPU6050_USER_CTRL, MPU6050_USER_FIFO_EN) < 0)
+  {
+    return -1;
+  }
+  // 이전 넘침 표시 지우기 (INT_STATUS는 읽으면 지워짐)
+  return read_regs(imu, MPU6050_INT_STATUS, &status, 1);
+}
+
+// ========== data-ready 인터럽트 켜기 ==========
+// INT 핀: active high, push-pull, 50us 펄스 (래치 없음 → 상승 에지 하나 = 샘플 하나)
+// FIFO 넘침도 같은 핀으로 알림
+int mpu6050_enable_data_ready(struct mpu6050 *imu)
+{
+  if (write_reg(imu, MPU6050_INT_PIN_CFG, 0x00) < 0 ||
+      write_reg(imu, MPU6050_INT_ENABLE, MPU6050_INT_DATA_RDY | MPU6050_INT_FIFO_OFLOW) < 0)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+// ========== FIFO에서 프레임 읽기 ==========
+// 반환값: 읽은 프레임 수 (0이면 쌓인 것 없음, 넘침이면 리셋 후 0), -1 I2C 에러
+int mpu6050_fifo_read(struct mpu6050 *imu, struct imu_raw *out, int max_frames)
+{
+  uint8_t buf[FIFO_READ_MAX_FRAMES * MPU6050_FRAME_BYTES];
+  uint8_t status;
+  uint8_t count_buf[2];
+  int count, frames;
+
+  // 넘침 확인: 1024바이트가 차면 오래된 데이터를 덮어써서 프레임 경계가 깨짐
+  if (read_regs(imu, MPU6050_INT_STATUS, &status, 1) < 0)
+  {
+    return -1;
+  }
+  if (status & MPU6050_INT_FIFO_OFLOW)
+  {
+    imu->overflows++;
+    return (mpu6050_fifo_reset(imu) < 0) ? -1 : 0;
+  }
+
+  if (read_regs(imu, MPU6050_FIFO_COUNTH, count_buf, 2) < 0)
+  {
+    return -1;
+  }
+  count = (count_buf[0] << 8) | count_buf[1];
+  if (count >= MPU6050_FIFO_SIZE)
+  {
+    // 넘침 직전까지 찬 경우도 같은 처리
+    imu->overflows++;
+    return (mpu6050_fifo_reset(imu) < 0) ? -1 : 0;
+  }
+
+  frames = count / MPU6050_FRAME_BYTES;
+  if (frames > max_frames)
+  {
+    frames = max_frames;
+  }
+  if (frames > FIFO_READ_MAX_FRAMES)
+  {
+    frames = FIFO_READ_MAX_FRAMES;
+  }
+  if (frames == 0)
+  {
+    return 0;
+  }
+
+  // FIFO_R_W 레지스터를 계속 읽으면 FIFO가 순서대로 나옴 (주소 자동 증가 없음)
+  if (read_regs(imu, MPU6050_FIFO_R_W, buf, frames * MPU6050_FRAME_BYTES) < 0)
+  {
+    return -1;
+  }
+
+  for (int i = 0; i < frames; i++)
+  {
+    const uint8_t *p = &buf[i * MPU6050_FRAME_BYTES];
+
+    // 2바이트씩 합쳐서 16비트 정수로 변환 (상위비트 << 8 | 하위비트)
+    out[i].ax = (int16_t)((p[0] << 8) | p[1]);
+    out[i].ay = (int16_t)((p[2] << 8) | p[3]);
+    out[i].az = (int16_t)((p[4] << 8) | p[5]);
+    out[i].gx = (int16_t)((p[6] << 8) | p[7]);
+    out[i].gy = (int16_t)((p[8] << 8) | p[9]);
+    out[i].gz = (int16_t)((p[10] << 8) | p[11]);
+  }
+
+  return frames;
+}
+
+// ========== 종료 ==========
+// 인터럽트와 FIFO를 끄고 센서를 재움
+void mpu6050_close(struct mpu6050 *imu)
+{
+  write_reg(imu, MPU6050_INT_ENABLE, 0x00);
+  write_reg(imu, MPU6050_FIFO_EN, 0x00);
+  write_reg(imu, MPU6050_USER_CTRL, 0x00);
+  write_reg(imu, MPU6050_PWR_MGMT_1, 0x40);   // SLEEP
+}
+
+// ========== 레지스터 쓰기 ==========
+static int write_reg(struct mpu6050 *imu, uint8_t reg, uint8_t value)
+{
+  uint8_t buf[2] = { reg, value };
+
+  return i2c_dev_write(&imu->dev, buf, 2);
+}
+
+// ========== 레지스터 연속 읽기 ==========
+// 레지스터 주소 쓰기와 읽기가 반복 START로 이어져 usleep이 필요 없음
+static int read_regs(struct mpu6050 *imu, uint8_t reg, uint8_t *buf, int len)
+{
+  return i2c_dev_write_read(&imu->dev, &reg, 1, buf, len);
+}
@@ -0,0 +1,66 @@
+/*
+파일명: mpu6050.h
+작성일: 2026-10-16
+설명: MPU6050 (GY-521) 가속도/자이로 센서 드라이버
+      샘플레이트 분주기로 측정 주기를 정하고 온칩 FIFO(1024바이트)에 쌓인
+      가속도+자이로 프레임(12바이트)을 한 번의 버스트 읽기로 가져옴
+ */
+
+#ifndef MPU6050_H
+#define MPU6050_H
+
+#include <stdint.h>
+#include "i2c_bus.h"
+
+#define MPU6050_ADDR 0x68          // AD0 = GND
+#define MPU6050_MAX_RATE_HZ 1000   // DLPF 사용 시 자이로 출력 1kHz
+#define MPU6050_FIFO_SIZE 1024
+#define MPU6050_FRAME_BYTES 12     // 가속도 XYZ + 자이로 XYZ (각 16비트)
+#define MPU6050_ACCEL_LSB_PER_G 16384.0    // ±2g
+#define MPU6050_GYRO_LSB_PER_DPS 131.0     // ±250 °/s
+
+// ========== 레지스터 ==========
+#define MPU6050_SMPLRT_DIV 0x19
+#define MPU6050_CONFIG 0x1A
+#define MPU6050_GYRO_CONFIG 0x1B
+#define MPU6050_ACCEL_CONFIG 0x1C
+#define MPU6050_FIFO_EN 0x23
+#define MPU6050_INT_PIN_CFG 0x37
+#define MPU6050_INT_ENABLE 0x38
+#define MPU6050_INT_STATUS 0x3A
+#define MPU6050_ACCEL_XOUT_H 0x3B
+#define MPU6050_USER_CTRL 0x6A
+#define MPU6050_PWR_MGMT_1 0x6B
+#define MPU6050_FIFO_COUNTH 0x72
+#define MPU6050_FIFO_R_W 0x74
+#define MPU6050_WHO_AM_I 0x75
+
+// 비트
+#define MPU6050_FIFO_EN_ACCEL_GYRO 0x78   // XG, YG, ZG, ACCEL
+#define MPU6050_USER_FIFO_EN 0x40
+#define MPU6050_USER_FIFO_RESET 0x04
+#define MPU6050_INT_FIFO_OFLOW 0x10
+#define MPU6050_INT_DATA_RDY 0x01
+
+// ========== 원시 샘플 (FIFO 프레임 하나) ==========
+struct imu_raw
+{
+  int16_t ax, ay, az;
+  int16_t gx, gy, gz;
+};
+
+// ========== 센서 상태 ==========
+struct mpu6050
+{
+  struct i2c_dev dev;          // 공유 버스 위의 장치 (센서 우선순위)
+  int rate_hz;                 // 실제 샘플레이트 (1000 / (1 + 분주기))
+  uint64_t overflows;          // FIFO 넘침 횟수 (넘칠 때마다 FIFO 리셋)
+};
+
+int mpu6050_init(struct mpu6050 *imu, struct i2c_bus *bus, uint16_t addr, int rate_hz);
+int mpu6050_fifo_read(struct mpu6050 *imu, struct imu_raw *out, int max_frames);
+int mpu6050_fifo_reset(struct mpu6050 *imu);
+int mpu6050_enable_data_ready(struct mpu6050 *imu);
+void mpu6050_close(struct mpu6050 *imu);
+
+#endif
@@ -0,0 +1,184 @@
+/*
+파일명: partition.c
+작성일: 2026-10-16
+설명: 기간별 DB 파일(파티션) 이름 규칙과 보관 예산
+      파일 이름에 구간 시작 시각을 넣어 이름순 정렬이 곧 시간순이 되게 함
+      예산을 넘으면 가장 오래된 파티션부터 파일째 지움 (WAL/SHM 파일 포함)
+ */
+
+#define _GNU_SOURCE   // strptime, timegm
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "partition.h"
+
+static int is_partition(const struct dirent *entry);
+static int64_t file_bytes(const char *path);
+static void remove_partition(const char *path);
+
+// ========== epoch 초 → 파티션 번호 ==========
+int64_t partition_index(int64_t epoch_s, int window_s)
+{
+  return epoch_s / window_s;
+}
+
+// ========== 파티션 번호 → 파일 경로 ==========
+void partition_path(char *out, size_t size, const char *dir, int64_t index, int window_s)
+{
+  time_t start = index * window_s;
+  struct tm tm;
+  char stamp[32];
+
+  gmtime_r(&start, &tm);
+  strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M", &tm);
+  snprintf(out, size, "%s/%s%s%s", dir, PARTITION_PREFIX, stamp, PARTITION_SUFFIX);
+}
+
+// ========== 파일 이름 → 구간 시작 epoch 초 (형식이 다르면 -1) ==========
+int64_t partition_start_s(const char *name)
+{
+  struct tm tm;
+  const char *end;
+  size_t prefix_len = strlen(PARTITION_PREFIX);
+
+  if (strncmp(name, PARTITION_PREFIX, prefix_len) != 0)
+  {
+    return -1;
+  }
+
+  memset(&tm, 0, sizeof(tm));
+  end = strptime(name + prefix_len, "%Y%m%d-%H%M", &tm);
+  if (end == NULL || strcmp(end, PARTITION_SUFFIX) != 0)
+  {
+    return -1;
+  }
+  return timegm(&tm);
+}
+
+// ========== 디렉터리의 파티션 목록 (오래된 것부터) ==========
+// 돌려받은 목록은 partition_free로 해제
+int partition_scan(const char *dir, struct dirent ***list)
+{
+  return scandir(dir, list, is_partition, alphasort);
+}
+
+// ========== 목록 해제 ==========
+void partition_free(struct dirent **list, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    free(list[i]);
+  }
+  free(list);
+}
+
+// ========== 보관 예산 적용 ==========
+// 오래된 파티션부터 나이 예산을 넘었거나 전체 크기가 예산을 넘는 동안 삭제
+// 지운 파티션 수를 돌려줌 (목록을 못 읽으면 -1)
+int partition_enforce(const char *dir, const char *current_path, int window_s,
+                      const struct partition_budget *budget, int64_t now_s)
+{
+  struct dirent **list;
+  int64_t *bytes;
+  int64_t total = 0;
+  int count, removed = 0;
+  char path[PARTITION_PATH_MAX];
+
+  if (budget->max_bytes <= 0 && budget->max_age_s <= 0)
+  {
+    return 0;
+  }
+
+  count = partition_scan(dir, &list);
+  if (count < 0)
+  {
+    perror("partition scan");
+    return -1;
+  }
+
+  bytes = malloc((count + 1) * sizeof(*bytes));
+  if (bytes == NULL)
+  {
+    partition_free(list, count);
+    return -1;
+  }
+
+  // 크기는 한 번만 재고 지울 때마다 합계에서 뺌
+  for (int i = 0; i < count; i++)
+  {
+    snprintf(path, sizeof(path), "%s/%s", dir, list[i]->d_name);
+    bytes[i] = file_bytes(path);
+    total += bytes[i];
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    int64_t start_s = partition_start_s(list[i]->d_name);
+    bool too_old, too_big;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, list[i]->d_name);
+    if (strcmp(path, current_path) == 0)
+    {
+      break;   // 현재 파티션과 그 뒤(시계가 되돌아간 경우)는 남김
+    }
+
+    too_old = budget->max_age_s > 0 && start_s + window_s <= now_s - budget->max_age_s;
+    too_big = budget->max_bytes > 0 && total > budget->max_bytes;
+    if (!too_old && !too_big)
+    {
+      break;
+    }
+
+    remove_partition(path);
+    total -= bytes[i];
+    removed++;
+  }
+
+  free(bytes);
+  partition_free(list, count);
+  return removed;
+}
+
+// ========== scandir 필터 ==========
+static int is_partition(const struct dirent *entry)
+{
+  return partition_start_s(entry->d_name) >= 0;
+}
+
+// ========== DB 파일 + WAL 크기 ==========
+static int64_t file_bytes(const char *path)
+{
+  char wal[PARTITION_PATH_MAX + 8];
+  struct stat sb;
+  int64_t total = 0;
+
+  if (stat(path, &sb) == 0)
+  {
+    total += sb.st_size;
+  }
+  snprintf(wal, sizeof(wal), "%s-wal", path);
+  if (stat(wal, &sb) == 0)
+  {
+    total += sb.st_size;
+  }
+  return total;
+}
+
+// ========== 파티션 파일 삭제 (WAL/SHM 포함) ==========
+static void remove_partition(const char *path)
+{
+  char side[PARTITION_PATH_MAX + 8];
+
+  if (unlink(path) < 0)
+  {
+    perror(path);
+  }
+  snprintf(side, sizeof(side), "%s-wal", path);
+  unlink(side);
+  snprintf(side, sizeof(side), "%s-shm", path);
+  unlink(side);
+}
@@ -0,0 +1,39 @@
+/*
+파일명: partition.h
+작성일: 2026-10-16
+설명: 기간별 DB 파일(파티션) 이름 규칙과 보관 예산
+      DIR/ultrasonic-YYYYMMDD-HHMM.db (UTC 시작 시각) 하나가 한 구간 (기본 하루)
+      오래된 데이터는 DELETE + VACUUM 대신 파일째 unlink하므로 지우는 비용이 일정
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <dirent.h>
+
+#define PARTITION_PREFIX "ultrasonic-"
+#define PARTITION_SUFFIX ".db"
+#define PARTITION_DEFAULT_WINDOW_S 86400   // 기본 구간 (하루)
+#define PARTITION_ENFORCE_S 3600           // 쓰는 중인 파티션이 자라는 동안 예산 재검사 간격
+#define PARTITION_MAX_ATTACH 10            // SQLite 기본 ATTACH 한도 (SQLITE_MAX_ATTACHED)
+#define PARTITION_PATH_MAX 512
+
+// ========== 보관 예산 ==========
+// 둘 다 0이면 지우지 않음, 현재 파티션은 예산을 넘어도 지우지 않음
+struct partition_budget
+{
+  int64_t max_bytes;   // 전체 크기 (WAL 포함)
+  int64_t max_age_s;   // 구간 끝이 이보다 오래되면 삭제
+};
+
+int64_t partition_index(int64_t epoch_s, int window_s);
+void partition_path(char *out, size_t size, const char *dir, int64_t index, int window_s);
+int64_t partition_start_s(const char *name);
+int partition_scan(const char *dir, struct dirent ***list);
+void partition_free(struct dirent **list, int count);
+int partition_enforce(const char *dir, const char *current_path, int window_s,
+                      const struct partition_budget *budget, int64_t now_s);
+
+#endif
@@ -0,0 +1,96 @@
+/*
+파일명: ping_scheduler.c
+작성일: 2026-10-16
+설명: 연속 측정용 적응형 핑 간격
+      간격 = 에코 왕복 시간 x 3 + 잔향 감쇠, 10~60ms로 제한
+      20cm 물체면 10ms(100Hz), 1m면 약 21ms, 3.2m 이상이거나 에코가 없으면 60ms
+ */
+
+#include <stdio.h>
+#include "ultrasonic.h"
+#include "ping_scheduler.h"
+
+// ========== 초기화 ==========
+// 첫 핑은 start_ns에 나감
+void ping_scheduler_init(struct ping_scheduler *ps, int64_t start_ns)
+{
+  ps->next_ns = start_ns;
+  ps->started_ns = start_ns;
+  ps->last_ns = start_ns;
+  ps->pings = 0;
+  ps->overruns = 0;
+  ps->interval_min_ns = 0;
+  ps->interval_max_ns = 0;
+}
+
+// ========== 직전 측정 결과로 다음 핑까지의 간격 계산 ==========
+// 에코가 빨리 돌아와도 같은 버스트의 다중 반사와 잔향이 사라진 뒤에 쏨
+// (빔 밖의 먼 벽에서 늦게 오는 반사는 막지 못하므로 그런 곳에서는 -c 없이 사용)
+int64_t ping_interval_ns(int status, int64_t pulse_ns)
+{
+  int64_t interval_ns;
+
+  if (status != US_OK)
+  {
+    return PING_MAX_INTERVAL_NS;
+  }
+
+  interval_ns = PING_ECHO_MULTIPLE * pulse_ns + PING_RINGDOWN_NS;
+  if (interval_ns < PING_MIN_INTERVAL_NS)
+  {
+    return PING_MIN_INTERVAL_NS;
+  }
+  if (interval_ns > PING_MAX_INTERVAL_NS)
+  {
+    return PING_MAX_INTERVAL_NS;
+  }
+  return interval_ns;
+}
+
+// ========== 다음 핑 예약 ==========
+// 예약 시각에 간격을 더하므로 깨어남/측정 지연이 다음 주기로 쌓이지 않음
+// 에코 대기가 길어져 이미 지났으면 지금 + 잔향 감쇠 시간으로 미룸
+int64_t ping_scheduler_next(struct ping_scheduler *ps, int status, int64_t pulse_ns,
+                            int64_t now_ns)
+{
+  int64_t interval_ns = ping_interval_ns(status, pulse_ns);
+
+  ps->pings++;
+  ps->last_ns = ps->next_ns;
+  ps->next_ns += interval_ns;
+  if (ps->next_ns < now_ns + PING_RINGDOWN_NS)
+  {
+    ps->next_ns = now_ns + PING_RINGDOWN_NS;
+    ps->overruns++;
+  }
+
+  interval_ns = ps->next_ns - ps->last_ns;
+  if (ps->pings == 1 || interval_ns < ps->interval_min_ns)
+  {
+    ps->interval_min_ns = interval_ns;
+  }
+  if (interval_ns > ps->interval_max_ns)
+  {
+    ps->interval_max_ns = interval_ns;
+  }
+  return ps->next_ns;
+}
+
+// ========== 달성한 핑 속도 출력 ==========
+void ping_scheduler_print_stats(const struct ping_scheduler *ps)
+{
+  double elapsed_s = (ps->last_ns - ps->started_ns) / 1e9;
+
+  if (ps->pings < 2 || elapsed_s <= 0)
+  {
+    return;
+  }
+
+  // 첫 핑부터 마지막 핑까지 (pings - 1)개의 간격
+  printf("연속 측정: 핑 %llu회, %.1f pings/s (간격 평균 %.2f ms, 최소 %.2f ms, 최대 %.2f ms)\n",
+         (unsigned long long)ps->pings, (ps->pings - 1) / elapsed_s,
+         elapsed_s * 1000.0 / (ps->pings - 1),
+         ps->interval_min_ns / 1e6, ps->interval_max_ns / 1e6);
+  printf("연속 측정 예약 밀림: %llu회 (에코 대기가 간격보다 길었음)\n",
+         (unsigned long long)ps->overruns);
+}
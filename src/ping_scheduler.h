@@ -0,0 +1,41 @@
+/*
+파일명: ping_scheduler.h
+작성일: 2026-10-16
+설명: 연속 측정용 적응형 핑 간격
+      직전 에코가 짧으면(가까운 물체) 다음 핑을 앞당기고,
+      에코가 없거나 멀면 데이터시트 권장 주기(60ms)로 되돌아감
+      다음 핑 시각은 직전 예약 시각 + 간격이라 지연이 누적되지 않음
+ */
+
+#ifndef PING_SCHEDULER_H
+#define PING_SCHEDULER_H
+
+#include <stdint.h>
+
+// ========== 간격 상수 ==========
+#define PING_MIN_INTERVAL_NS 10000000LL  // 가장 짧은 핑 간격 (최대 100Hz)
+#define PING_MAX_INTERVAL_NS 60000000LL  // 에코 없음/먼 거리 (HC-SR04 권장 주기)
+#define PING_RINGDOWN_NS 4000000LL       // 에코가 끝난 뒤 트랜스듀서 잔향 감쇠 시간
+#define PING_ECHO_MULTIPLE 3             // 다중 반사(거리 2배, 3배)가 사라질 때까지의 에코 배수
+
+// ========== 스케줄러 상태 ==========
+struct ping_scheduler
+{
+  int64_t next_ns;          // 다음 핑 예약 시각 (CLOCK_MONOTONIC)
+  int64_t started_ns;       // 첫 핑 예약 시각
+  int64_t last_ns;          // 마지막 핑 예약 시각
+
+  // 통계
+  uint64_t pings;
+  uint64_t overruns;        // 측정이 길어져 예약 시각을 뒤로 민 횟수
+  int64_t interval_min_ns;
+  int64_t interval_max_ns;
+};
+
+void ping_scheduler_init(struct ping_scheduler *ps, int64_t start_ns);
+int64_t ping_interval_ns(int status, int64_t pulse_ns);
+int64_t ping_scheduler_next(struct ping_scheduler *ps, int status, int64_t pulse_ns,
+                            int64_t now_ns);
+void ping_scheduler_print_stats(const struct ping_scheduler *ps);
+
+#endif
@@ -0,0 +1,277 @@
+/*
+파일명: rt_acquire.c
+작성일: 2026-10-16
+설명: 실시간 초음파 측정 스레드
+      메인 루프는 eventfd로 측정 시각만 전달하고, 스레드는 그 시각에 맞춰
+      clock_nanosleep(TIMER_ABSTIME)으로 깨어나 트리거 → 에코 측정 후
+      결과를 SPSC 링에 넣음. 어느 쪽도 상대를 기다리며 블로킹하지 않음
+      연속 측정 모드에서는 직전 에코로 다음 핑 시각을 스스로 정함
+      버스트 측정은 K번 핑을 적응형 간격으로 이어 쏘고 중앙값 하나만 넘김
+ */
+
+#define _GNU_SOURCE     // pthread_attr_setaffinity_np, CPU_SET
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include "rt_acquire.h"
+#include "event_loop.h"
+
+static void *acquire_thread(void *arg);
+static void *continuous_thread(void *arg);
+static void measure_burst(struct rt_acquire *rt, struct ping_scheduler *ps,
+                          struct sample *s);
+static void prefault_stack(void);
+
+// ========== 스레드 시작 ==========
+// cpu < 0이면 CPU 고정 없이 SCHED_FIFO만 적용
+int rt_acquire_start(struct rt_acquire *rt, struct ultrasonic *us, int cpu, int priority,
+                     bool continuous, int burst_size)
+{
+  pthread_attr_t attr;
+  struct sched_param param;
+  cpu_set_t cpus;
+  int ret;
+
+  rt->us = us;
+  rt->continuous = continuous;
+  burst_init(&rt->burst, burst_size);
+  atomic_init(&rt->request_at_ns, 0);
+  atomic_init(&rt->request_num, 0);
+  atomic_init(&rt->stop, false);
+  sample_ring_init(&rt->ring);
+
+  rt->request_fd = eventfd(0, EFD_CLOEXEC);
+  rt->done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (rt->request_fd < 0 || rt->done_fd < 0)
+  {
+    perror("eventfd");
+    return -1;
+  }
+
+  // 현재와 이후의 모든 페이지를 메모리에 고정 (측정 중 페이지 폴트 방지)
+  // 프로세스 전체에 걸리므로 다른 스레드도 모두 작은 스택 크기를 지정해 만듦
+  // (기본 8MB 스택이면 스레드마다 8MB가 RAM에 고정됨)
+  rt->locked = false;
+  if (priority > 0)
+  {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+      perror("mlockall");
+      return -1;
+    }
+    rt->locked = true;
+  }
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, RT_STACK_SIZE);
+  if (priority > 0)
+  {
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    pthread_attr_setschedparam(&attr, &param);
+  }
+
+  if (cpu >= 0)
+  {
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+  }
+
+  ret = pthread_create(&rt->thread, &attr,
+                       continuous ? continuous_thread : acquire_thread, rt);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("pthread_create (acquire)");
+    if (rt->locked)
+    {
+      munlockall();
+      rt->locked = false;
+    }
+    return -1;
+  }
+
+  return 0;
+}
+
+// ========== 측정 요청 (메인 루프) ==========
+// 결과를 받기 전에는 다음 요청을 보내지 않으므로 슬롯 하나로 충분
+void rt_acquire_request(struct rt_acquire *rt, int64_t at_ns, int num)
+{
+  uint64_t one = 1;
+
+  atomic_store(&rt->request_at_ns, at_ns);
+  atomic_store(&rt->request_num, num);
+  if (write(rt->request_fd, &one, sizeof(one)) != sizeof(one))
+  {
+    perror("rt request write");
+  }
+}
+
+// ========== 결과 알림 fd ==========
+int rt_acquire_done_fd(struct rt_acquire *rt)
+{
+  return rt->done_fd;
+}
+
+// ========== 결과 꺼내기 (메인 루프) ==========
+bool rt_acquire_poll(struct rt_acquire *rt, struct sample *out)
+{
+  uint64_t count;
+
+  // 알림 카운터는 비워 두고, 실제 결과는 링에서 꺼냄
+  if (read(rt->done_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+  {
+    perror("rt done read");
+  }
+  return sample_ring_pop(&rt->ring, out);
+}
+
+// ========== 스레드 종료 ==========
+void rt_acquire_stop(struct rt_acquire *rt)
+{
+  uint64_t one = 1;
+
+  atomic_store(&rt->stop, true);
+  if (write(rt->request_fd, &one, sizeof(one)) != sizeof(one))
+  {
+    perror("rt stop write");
+  }
+  pthread_join(rt->thread, NULL);
+
+  close(rt->request_fd);
+  close(rt->done_fd);
+  if (rt->locked)
+  {
+    munlockall();
+    rt->locked = false;
+  }
+}
+
+// ========== 측정 스레드 본체 ==========
+static void *acquire_thread(void *arg)
+{
+  struct rt_acquire *rt = arg;
+  struct ping_scheduler ps;
+  struct sample s;
+  uint64_t value;
+
+  prefault_stack();
+
+  while (!atomic_load(&rt->stop))
+  {
+    // 요청이 올 때까지 대기 (eventfd 블로킹 읽기)
+    if (read(rt->request_fd, &value, sizeof(value)) != sizeof(value))
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      break;
+    }
+    if (atomic_load(&rt->stop))
+    {
+      break;
+    }
+
+    // 버스트 안의 핑 간격은 요청마다 새 스케줄러로 정함
+    memset(&s, 0, sizeof(s));
+    ping_scheduler_init(&ps, atomic_load(&rt->request_at_ns));
+    s.num = atomic_load(&rt->request_num);
+    s.ir_triggered = 1;
+    measure_burst(rt, &ps, &s);
+  }
+
+  return NULL;
+}
+
+// ========== 연속 측정 스레드 본체 ==========
+// 요청을 기다리지 않고 ping_scheduler가 정한 시각마다 핑
+// 종료 요청은 핑 사이(최대 60ms)에 확인
+static void *continuous_thread(void *arg)
+{
+  struct rt_acquire *rt = arg;
+  struct sample s;
+  int num = 0;
+
+  prefault_stack();
+  ping_scheduler_init(&rt->sched, monotonic_ns() + PING_MIN_INTERVAL_NS);
+
+  while (!atomic_load(&rt->stop))
+  {
+    memset(&s, 0, sizeof(s));
+    s.num = ++num;
+    measure_burst(rt, &rt->sched, &s);
+  }
+
+  return NULL;
+}
+
+// ========== 측정 1회 (K번 핑) + 결과 전달 ==========
+// 핑마다 ps가 정한 시각까지 절대 시각으로 잠듦 (SCHED_FIFO라 깨어나면 바로 실행)
+// 예약/트리거/상승 시각은 첫 유효 핑 것을 남김 (타이밍 통계용)
+static void measure_burst(struct rt_acquire *rt, struct ping_scheduler *ps,
+                          struct sample *s)
+{
+  struct timespec at;
+  uint64_t value = 1;
+  int64_t pulse_ns = 0;
+  bool done = false;
+
+  burst_begin(&rt->burst, ps->next_ns);
+
+  while (!done)
+  {
+    int64_t ping_at_ns = ps->next_ns;
+    int status;
+
+    at.tv_sec = ping_at_ns / 1000000000LL;
+    at.tv_nsec = ping_at_ns % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) == EINTR)
+    {
+    }
+
+    status = ultrasonic_measure(rt->us, &pulse_ns);
+    if (rt->burst.count == 0 || (status == US_OK && rt->burst.valid == 0))
+    {
+      s->scheduled_ns = ping_at_ns;
+      s->trigger_ns = rt->us->trigger_ns;
+      s->rise_ns = (status == US_OK) ? rt->us->rise_ns : 0;
+    }
+
+    done = burst_add(&rt->burst, status, pulse_ns);
+    ping_scheduler_next(ps, status, pulse_ns, monotonic_ns());
+  }
+
+  s->spread_ns = -1;
+  s->status = burst_reduce(&rt->burst, monotonic_ns(), &s->pulse_ns, &s->spread_ns);
+  s->pings = rt->burst.valid;
+
+  sample_ring_push(&rt->ring, s);
+
+  if (write(rt->done_fd, &value, sizeof(value)) != sizeof(value))
+  {
+    perror("rt done write");
+  }
+}
+
+// ========== 스택 미리 건드리기 ==========
+// 스택 페이지를 지금 할당받아 두면 측정 중 첫 접근 페이지 폴트가 없음
+static void prefault_stack(void)
+{
+  volatile unsigned char stack[RT_STACK_PREFAULT];
+
+  for (size_t i = 0; i < sizeof(stack); i += 4096)
+  {
+    stack[i] = 0;
+  }
+}
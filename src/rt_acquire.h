@@ -0,0 +1,52 @@
+/*
+파일명: rt_acquire.h
+작성일: 2026-10-16
+설명: 실시간 초음파 측정 스레드 (선택 사항, -r 옵션)
+      SCHED_FIFO + CPU 고정 + mlockall로 LCD/SQLite 지연과 분리
+      연속 측정 모드(-c)에서는 요청 없이 적응형 간격으로 계속 핑
+      측정 한 번은 K번 핑의 중앙값 (-k 옵션, 기본 1번)
+ */
+
+#ifndef RT_ACQUIRE_H
+#define RT_ACQUIRE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "ultrasonic.h"
+#include "sample_ring.h"
+#include "ping_scheduler.h"
+#include "burst.h"
+
+#define RT_DEFAULT_PRIORITY 80        // SCHED_FIFO 우선순위
+#define RT_STACK_SIZE (256 * 1024)    // 스레드 스택 크기
+#define RT_STACK_PREFAULT (64 * 1024) // 시작 시 미리 건드려 둘 스택 크기
+
+// ========== 실시간 측정 스레드 ==========
+struct rt_acquire
+{
+  pthread_t thread;
+  struct ultrasonic *us;    // 스레드가 단독으로 사용 (메인 루프는 건드리지 않음)
+  int request_fd;           // eventfd: 메인 루프 → 스레드 (측정 요청)
+  int done_fd;              // eventfd: 스레드 → 메인 루프 (결과 있음, epoll 등록용)
+  _Atomic int64_t request_at_ns;   // 요청된 트리거 시각
+  _Atomic int32_t request_num;     // 요청된 측정 번호
+  _Atomic bool stop;
+  bool locked;              // mlockall이 성공했으면 종료 때 munlockall
+  struct sample_ring ring;  // 측정 결과 (스레드 → 메인 루프)
+
+  bool continuous;          // true: 요청 없이 sched가 정한 시각마다 핑
+  struct ping_scheduler sched;  // 스레드만 사용, 종료 후 통계 읽기
+  struct burst burst;       // 측정 한 번의 K개 핑 (스레드만 사용, 종료 후 통계 읽기)
+};
+
+// priority가 0이면 SCHED_FIFO/mlockall 없이 일반 스레드로 실행
+int rt_acquire_start(struct rt_acquire *rt, struct ultrasonic *us, int cpu, int priority,
+                     bool continuous, int burst_size);
+void rt_acquire_request(struct rt_acquire *rt, int64_t at_ns, int num);
+int rt_acquire_done_fd(struct rt_acquire *rt);
+bool rt_acquire_poll(struct rt_acquire *rt, struct sample *out);
+void rt_acquire_stop(struct rt_acquire *rt);
+
+#endif
@@ -0,0 +1,440 @@
+/*
+파일명: sample_log.c
+작성일: 2026-10-16
+설명: 추가 전용(append-only) 바이너리 측정 로그
+      세그먼트는 posix_fallocate로 블록을 미리 잡아 두고 MAP_SHARED로 매핑하므로
+      레코드 하나 쓰기는 CRC 계산 + 32바이트 복사뿐 (시스템 호출 없음)
+      디스크로 내리는 것은 세그먼트를 닫을 때 msync 한 번, 그 뒤 쓴 만큼으로 잘라냄
+      닫히지 않은 세그먼트(전원 차단 등)는 다음에 열 때 CRC가 맞는 곳까지만 살려 닫음
+ */
+
+#define _GNU_SOURCE   // posix_fallocate, O_CLOEXEC
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "sample_log.h"
+
+#define RECORD_CRC_BYTES offsetof(struct sample_log_record, crc)
+
+static uint32_t crc_table[256];
+static bool crc_ready = false;
+
+static void crc_init(void);
+static int open_segment(struct sample_log *log);
+static void close_segment(struct sample_log *log);
+static int recover_segment(struct sample_log *log, const char *path);
+static uint32_t count_valid(const struct sample_log_record *records, uint32_t capacity, bool *torn);
+static uint64_t next_id(uint64_t after);
+static void segment_path(char *out, size_t size, const char *dir, uint64_t id);
+static int is_segment(const struct dirent *entry);
+
+// ========== 로그 열기 ==========
+// 디렉터리가 없으면 만들고, 마지막 세그먼트가 열린 채 끝났으면 복구해서 닫은 뒤
+// 지금 시각(남은 세그먼트보다 뒤)을 id로 한 새 세그먼트에서 시작
+int sample_log_open(struct sample_log *log, const char *dir, uint32_t capacity)
+{
+  struct dirent **list;
+  int count;
+
+  crc_init();
+  snprintf(log->dir, sizeof(log->dir), "%s", dir);
+  log->fd = -1;
+  log->map = NULL;
+  log->capacity = capacity;
+  log->count = 0;
+  log->id = 0;
+  log->appended = 0;
+  log->segments = 0;
+  log->msyncs = 0;
+  log->recovered = 0;
+  log->torn = 0;
+
+  if (mkdir(dir, 0755) < 0 && errno != EEXIST)
+  {
+    perror(dir);
+    return -1;
+  }
+
+  count = sample_log_scan(dir, &list);
+  if (count < 0)
+  {
+    perror(dir);
+    return -1;
+  }
+  if (count > 0)
+  {
+    char path[SAMPLE_LOG_PATH_MAX];
+
+    log->id = sample_log_id(list[count - 1]->d_name);
+    snprintf(path, sizeof(path), "%s/%s", dir, list[count - 1]->d_name);
+    if (recover_segment(log, path) < 0)
+    {
+      sample_log_free(list, count);
+      return -1;
+    }
+  }
+  sample_log_free(list, count);
+
+  log->id = next_id(log->id);
+  return open_segment(log);
+}
+
+// ========== 레코드 하나 추가 ==========
+// crc는 여기서 채움. 세그먼트가 가득 차면 닫고 다음 세그먼트를 엶
+int sample_log_append(struct sample_log *log, struct sample_log_record *rec)
+{
+  if (log->map == NULL)
+  {
+    return -1;
+  }
+  if (log->count == log->capacity)
+  {
+    close_segment(log);
+    log->id = next_id(log->id);
+    if (open_segment(log) < 0)
+    {
+      return -1;
+    }
+  }
+
+  rec->reserved = 0;
+  rec->pad = 0;
+  rec->crc = sample_log_crc(rec, RECORD_CRC_BYTES);
+  log->records[log->count++] = *rec;
+  log->appended++;
+  return 0;
+}
+
+// ========== 로그 닫기 ==========
+void sample_log_close(struct sample_log *log)
+{
+  if (log->map != NULL)
+  {
+    close_segment(log);
+  }
+}
+
+// ========== 디렉터리의 세그먼트 목록 (id순) ==========
+// 돌려받은 목록은 sample_log_free로 해제
+int sample_log_scan(const char *dir, struct dirent ***list)
+{
+  return scandir(dir, list, is_segment, alphasort);
+}
+
+// ========== 목록 해제 ==========
+void sample_log_free(struct dirent **list, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    free(list[i]);
+  }
+  free(list);
+}
+
+// ========== 파일 이름 → 세그먼트 id (형식이 다르면 -1) ==========
+int64_t sample_log_id(const char *name)
+{
+  size_t prefix_len = strlen(SAMPLE_LOG_PREFIX);
+  char *end;
+  long long id;
+
+  if (strncmp(name, SAMPLE_LOG_PREFIX, prefix_len) != 0)
+  {
+    return -1;
+  }
+  errno = 0;
+  id = strtoll(name + prefix_len, &end, 10);
+  if (errno != 0 || end == name + prefix_len || strcmp(end, SAMPLE_LOG_SUFFIX) != 0 || id < 0)
+  {
+    return -1;
+  }
+  return id;
+}
+
+// ========== 세그먼트 읽기용으로 열기 ==========
+// 헤더를 확인하고 CRC가 맞는 앞부분 길이를 셈 (닫힌 세그먼트도 CRC는 다시 확인)
+int sample_log_segment_open(struct sample_log_segment *seg, const char *path)
+{
+  struct stat sb;
+  uint32_t capacity;
+  int fd;
+
+  crc_init();
+  seg->map = NULL;
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+  if (fstat(fd, &sb) < 0 || sb.st_size < (off_t)sizeof(struct sample_log_header))
+  {
+    fprintf(stderr, "%s: 세그먼트 헤더가 없음\n", path);
+    close(fd);
+    return -1;
+  }
+
+  seg->map_size = sb.st_size;
+  seg->map = mmap(NULL, seg->map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (seg->map == MAP_FAILED)
+  {
+    perror("mmap");
+    seg->map = NULL;
+    return -1;
+  }
+  madvise(seg->map, seg->map_size, MADV_SEQUENTIAL);
+
+  seg->header = seg->map;
+  seg->records = (const struct sample_log_record *)(seg->header + 1);
+  if (memcmp(seg->header->magic, SAMPLE_LOG_MAGIC, sizeof(SAMPLE_LOG_MAGIC)) != 0 ||
+      seg->header->record_size != sizeof(struct sample_log_record))
+  {
+    fprintf(stderr, "%s: 세그먼트 형식이 다름\n", path);
+    sample_log_segment_close(seg);
+    return -1;
+  }
+
+  // 잘라낸 파일은 쓴 만큼만 있으므로 파일 크기와 헤더 중 작은 쪽까지만 봄
+  capacity = (seg->map_size - sizeof(struct sample_log_header)) / sizeof(struct sample_log_record);
+  if (capacity > seg->header->capacity)
+  {
+    capacity = seg->header->capacity;
+  }
+  seg->closed = (seg->header->closed_count != SAMPLE_LOG_OPEN);
+  if (seg->closed && seg->header->closed_count < capacity)
+  {
+    capacity = seg->header->closed_count;
+  }
+  seg->valid = count_valid(seg->records, capacity, &seg->torn);
+  return 0;
+}
+
+// ========== 읽기용 세그먼트 닫기 ==========
+void sample_log_segment_close(struct sample_log_segment *seg)
+{
+  if (seg->map != NULL)
+  {
+    munmap(seg->map, seg->map_size);
+    seg->map = NULL;
+  }
+}
+
+// ========== CRC-32 (IEEE 802.3, zlib과 같은 값) ==========
+uint32_t sample_log_crc(const void *data, size_t len)
+{
+  const uint8_t *p = data;
+  uint32_t crc = 0xFFFFFFFFu;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    crc = crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+// ========== CRC 표 만들기 (처음 한 번) ==========
+static void crc_init(void)
+{
+  if (crc_ready)
+  {
+    return;
+  }
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    uint32_t c = i;
+
+    for (int k = 0; k < 8; k++)
+    {
+      c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    crc_table[i] = c;
+  }
+  crc_ready = true;
+}
+
+// ========== 새 세그먼트 만들기 ==========
+// 블록을 미리 할당해 쓰는 중에 파일 시스템이 공간을 찾느라 멈추지 않게 함
+static int open_segment(struct sample_log *log)
+{
+  char path[SAMPLE_LOG_PATH_MAX];
+  int ret;
+
+  segment_path(path, sizeof(path), log->dir, log->id);
+  log->map_size = sizeof(struct sample_log_header) +
+                  (size_t)log->capacity * sizeof(struct sample_log_record);
+
+  log->fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (log->fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+  ret = posix_fallocate(log->fd, 0, log->map_size);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("posix_fallocate");
+    close(log->fd);
+    unlink(path);
+    log->fd = -1;
+    return -1;
+  }
+
+  log->map = mmap(NULL, log->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, log->fd, 0);
+  if (log->map == MAP_FAILED)
+  {
+    perror("mmap");
+    close(log->fd);
+    unlink(path);
+    log->fd = -1;
+    log->map = NULL;
+    return -1;
+  }
+  madvise(log->map, log->map_size, MADV_SEQUENTIAL);
+
+  log->header = log->map;
+  log->records = (struct sample_log_record *)(log->header + 1);
+  memset(log->header, 0, sizeof(*log->header));
+  memcpy(log->header->magic, SAMPLE_LOG_MAGIC, sizeof(SAMPLE_LOG_MAGIC));
+  log->header->record_size = sizeof(struct sample_log_record);
+  log->header->capacity = log->capacity;
+  log->header->id = log->id;
+  log->header->closed_count = SAMPLE_LOG_OPEN;
+  log->count = 0;
+  return 0;
+}
+
+// ========== 세그먼트 닫기 ==========
+// 레코드 수를 헤더에 적고 쓴 범위를 msync 한 번으로 내린 뒤 남은 공간은 잘라냄
+// (잘라내기가 전원 차단으로 사라져도 헤더의 레코드 수와 CRC로 끝을 알 수 있음)
+static void close_segment(struct sample_log *log)
+{
+  size_t used = sizeof(struct sample_log_header) +
+                (size_t)log->count * sizeof(struct sample_log_record);
+
+  log->header->closed_count = log->count;
+  if (msync(log->map, used, MS_SYNC) < 0)
+  {
+    perror("msync");
+  }
+  log->msyncs++;
+  munmap(log->map, log->map_size);
+  log->map = NULL;
+
+  if (log->count == 0)
+  {
+    // 빈 세그먼트는 남기지 않음
+    char path[SAMPLE_LOG_PATH_MAX];
+
+    segment_path(path, sizeof(path), log->dir, log->id);
+    unlink(path);
+  }
+  else
+  {
+    if (ftruncate(log->fd, used) < 0)
+    {
+      perror("ftruncate");
+    }
+    log->segments++;
+  }
+  close(log->fd);
+  log->fd = -1;
+}
+
+// ========== 열린 채 끝난 세그먼트 복구 ==========
+// CRC가 맞는 앞부분만 남기고 닫힌 세그먼트로 표시 (이미 닫혔으면 그대로 둠)
+static int recover_segment(struct sample_log *log, const char *path)
+{
+  struct sample_log_segment seg;
+  struct sample_log_header header;
+  size_t used;
+  int fd;
+
+  if (sample_log_segment_open(&seg, path) < 0)
+  {
+    return -1;
+  }
+  if (seg.closed)
+  {
+    sample_log_segment_close(&seg);
+    return 0;
+  }
+  header = *seg.header;
+  log->recovered = seg.valid;
+  log->torn = seg.torn ? 1 : 0;
+  sample_log_segment_close(&seg);
+
+  fd = open(path, O_RDWR | O_CLOEXEC);
+  if (fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+  header.closed_count = log->recovered;
+  used = sizeof(header) + (size_t)log->recovered * sizeof(struct sample_log_record);
+  if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+      ftruncate(fd, used) < 0 || fsync(fd) < 0)
+  {
+    perror(path);
+    close(fd);
+    return -1;
+  }
+  close(fd);
+
+  fprintf(stderr, "%s: 닫히지 않은 세그먼트 복구 (레코드 %u개%s)\n", path, log->recovered,
+          log->torn ? ", 반쯤 써진 꼬리 1개 버림" : "");
+  return 0;
+}
+
+// ========== CRC가 맞는 앞부분 레코드 수 ==========
+// 처음 어긋난 레코드가 전부 0이면 미리 할당한 빈 영역, 아니면 반쯤 써진 꼬리
+static uint32_t count_valid(const struct sample_log_record *records, uint32_t capacity, bool *torn)
+{
+  static const struct sample_log_record zero;
+  uint32_t i;
+
+  for (i = 0; i < capacity; i++)
+  {
+    if (sample_log_crc(&records[i], RECORD_CRC_BYTES) != records[i].crc)
+    {
+      break;
+    }
+  }
+  *torn = (i < capacity && memcmp(&records[i], &zero, sizeof(zero)) != 0);
+  return i;
+}
+
+// ========== 다음 세그먼트 id ==========
+// 지금 시각(CLOCK_REALTIME ns)이되 앞 세그먼트보다 작거나 같으면 바로 뒤 값
+// 카운터처럼 디렉터리가 비었다고 처음으로 돌아가지 않으므로 log_loaded와 겹치지 않음
+static uint64_t next_id(uint64_t after)
+{
+  struct timespec ts;
+  uint64_t now;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  now = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  return (now > after) ? now : after + 1;
+}
+
+// ========== 세그먼트 id → 파일 경로 ==========
+// id를 0으로 채워 이름순 정렬이 곧 id순이 되게 함
+static void segment_path(char *out, size_t size, const char *dir, uint64_t id)
+{
+  snprintf(out, size, "%s/%s%019llu%s", dir, SAMPLE_LOG_PREFIX, (unsigned long long)id,
+           SAMPLE_LOG_SUFFIX);
+}
+
+// ========== scandir 필터 ==========
+static int is_segment(const struct dirent *entry)
+{
+  return sample_log_id(entry->d_name) >= 0;
+}
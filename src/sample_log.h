@@ -0,0 +1,103 @@
+/*
+파일명: sample_log.h
+작성일: 2026-10-16
+설명: 추가 전용(append-only) 바이너리 측정 로그
+      미리 할당한 세그먼트 파일을 mmap해 32바이트 고정 크기 레코드를 memcpy로 이어 씀
+      레코드마다 CRC-32가 있어 전원이 끊겨 반쯤 써진 꼬리는 다시 열 때 잘라냄
+      세그먼트가 차면 msync 한 번으로 내리고 닫은 뒤 다음 세그먼트로 넘어감
+      세그먼트 id는 만든 시각(epoch ns)이라 db_load가 파일을 지워 디렉터리가 비어도 다시 쓰이지 않음
+      닫힌 세그먼트는 db_load로 ultrasonic 테이블에 한꺼번에 옮김
+ */
+
+#ifndef SAMPLE_LOG_H
+#define SAMPLE_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <dirent.h>
+
+#define SAMPLE_LOG_MAGIC "USLOG01"
+#define SAMPLE_LOG_PREFIX "samples-"
+#define SAMPLE_LOG_SUFFIX ".uslog"
+#define SAMPLE_LOG_DEFAULT_RECORDS (1u << 20)   // 세그먼트당 레코드 수 (32MB)
+#define SAMPLE_LOG_OPEN UINT32_MAX              // 헤더 closed_count: 아직 쓰는 중
+#define SAMPLE_LOG_PATH_MAX 512
+
+#define SAMPLE_LOG_FLAG_IR 0x01   // IR 감지로 시작한 측정
+
+// ========== 세그먼트 헤더 (파일 맨 앞, 레코드와 같은 32바이트) ==========
+struct sample_log_header
+{
+  char magic[8];            // SAMPLE_LOG_MAGIC
+  uint32_t record_size;     // sizeof(struct sample_log_record)
+  uint32_t capacity;        // 미리 할당한 레코드 수
+  uint64_t id;              // 세그먼트 id: 만든 시각 (유닉스 epoch ns, 파일 이름과 같음)
+  uint32_t closed_count;    // 닫을 때 기록한 레코드 수 (SAMPLE_LOG_OPEN이면 쓰는 중)
+  uint32_t reserved;
+};
+
+// ========== 레코드 ==========
+// 거리/IQR은 음속 표의 0.1mm 정수, 시각은 트리거 시각(유닉스 epoch ns)
+// crc는 앞 28바이트의 CRC-32 (미리 할당한 0 영역은 CRC가 맞지 않아 끝으로 판단)
+struct sample_log_record
+{
+  int64_t ts_ns;
+  int32_t distance_01mm;
+  int32_t spread_01mm;      // 단일 핑이면 -1
+  int32_t num;              // 측정 번호
+  int16_t sensor_id;
+  uint8_t flags;            // SAMPLE_LOG_FLAG_*
+  uint8_t reserved;
+  uint32_t pad;
+  uint32_t crc;
+};
+
+_Static_assert(sizeof(struct sample_log_header) == 32, "sample_log_header must be 32 bytes");
+_Static_assert(sizeof(struct sample_log_record) == 32, "sample_log_record must be 32 bytes");
+
+// ========== 쓰기 상태 ==========
+struct sample_log
+{
+  char dir[SAMPLE_LOG_PATH_MAX - 64];   // 경로 뒤에 세그먼트 파일 이름이 붙을 자리를 남김
+  int fd;
+  void *map;                         // 세그먼트 전체 매핑 (헤더 + 레코드)
+  size_t map_size;
+  struct sample_log_header *header;
+  struct sample_log_record *records;
+  uint32_t capacity;
+  uint32_t count;                    // 현재 세그먼트에 쓴 레코드 수
+  uint64_t id;                       // 현재 세그먼트 id
+
+  // 통계
+  uint64_t appended;
+  uint64_t segments;                 // 닫은 세그먼트 수
+  uint64_t msyncs;
+  uint32_t recovered;                // 다시 열 때 살린 레코드 수
+  uint32_t torn;                     // 다시 열 때 버린 꼬리 레코드 수 (0 또는 1)
+};
+
+// ========== 읽기용 세그먼트 (db_load, 복구) ==========
+struct sample_log_segment
+{
+  void *map;
+  size_t map_size;
+  const struct sample_log_header *header;
+  const struct sample_log_record *records;
+  uint32_t valid;    // 앞에서부터 CRC가 맞는 레코드 수
+  bool torn;         // valid 바로 뒤가 0이 아닌 (반쯤 써진) 레코드인지
+  bool closed;
+};
+
+int sample_log_open(struct sample_log *log, const char *dir, uint32_t capacity);
+int sample_log_append(struct sample_log *log, struct sample_log_record *rec);
+void sample_log_close(struct sample_log *log);
+
+int sample_log_scan(const char *dir, struct dirent ***list);
+void sample_log_free(struct dirent **list, int count);
+int64_t sample_log_id(const char *name);
+int sample_log_segment_open(struct sample_log_segment *seg, const char *path);
+void sample_log_segment_close(struct sample_log_segment *seg);
+uint32_t sample_log_crc(const void *data, size_t len);
+
+#endif
@@ -0,0 +1,133 @@
+/*
+파일명: sample_log_check.c
+작성일: 2026-10-16
+설명: 바이너리 로그 → db_load 반복 검증 (make check)
+      로그 5행 → db_load → 로그 5행 → db_load 순서로 돌려 10행이 모두 들어가는지 확인
+      db_load가 옮긴 세그먼트를 지워 디렉터리가 비어도 다음 세그먼트 id가 겹치지 않아야 함
+      임시 디렉터리에서 실행 (GPIO 없이, 같은 디렉터리의 ./db_load 사용)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sqlite3.h>
+#include "sample_log.h"
+
+#define ROWS_PER_RUN 5
+
+static int failures = 0;
+
+// ========== 로거 한 번 실행에 해당: 열고 n행 쓰고 닫음 ==========
+static int write_run(const char *dir, int first_num, int n)
+{
+  struct sample_log log;
+  struct timespec ts;
+
+  if (sample_log_open(&log, dir, 64) < 0)
+  {
+    return -1;
+  }
+  for (int i = 0; i < n; i++)
+  {
+    struct sample_log_record rec = { 0 };
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    rec.ts_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    rec.distance_01mm = 1000 + i;
+    rec.spread_01mm = -1;
+    rec.num = first_num + i;
+    if (sample_log_append(&log, &rec) < 0)
+    {
+      sample_log_close(&log);
+      return -1;
+    }
+  }
+  sample_log_close(&log);
+  return 0;
+}
+
+// ========== db_load 실행 (옮긴 세그먼트는 지움) ==========
+static int run_load(const char *dir, const char *db_path)
+{
+  char cmd[1024];
+
+  snprintf(cmd, sizeof(cmd), "./db_load %s %s > /dev/null", dir, db_path);
+  return (system(cmd) == 0) ? 0 : -1;
+}
+
+// ========== 결과 하나를 정수로 ==========
+static int64_t query_int(const char *db_path, const char *sql)
+{
+  sqlite3 *db;
+  sqlite3_stmt *stmt;
+  int64_t value = -1;
+
+  if (sqlite3_open(db_path, &db) != SQLITE_OK)
+  {
+    sqlite3_close(db);
+    return -1;
+  }
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+  {
+    value = sqlite3_column_int64(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+  return value;
+}
+
+static void expect(const char *name, int64_t got, int64_t want)
+{
+  bool ok = (got == want);
+
+  printf("%-28s %lld (기대 %lld)  %s\n", name, (long long)got, (long long)want, ok ? "통과" : "실패");
+  if (!ok)
+  {
+    failures++;
+  }
+}
+
+int main(void)
+{
+  char base[] = "/tmp/sample_log_check.XXXXXX";
+  char dir[sizeof(base) + 8];
+  char db_path[sizeof(base) + 16];
+  char cmd[sizeof(base) + 16];
+
+  if (mkdtemp(base) == NULL)
+  {
+    perror("mkdtemp");
+    return 1;
+  }
+  snprintf(dir, sizeof(dir), "%s/log", base);
+  snprintf(db_path, sizeof(db_path), "%s/check.db", base);
+
+  for (int run = 0; run < 2; run++)
+  {
+    if (write_run(dir, run * ROWS_PER_RUN + 1, ROWS_PER_RUN) < 0 || run_load(dir, db_path) < 0)
+    {
+      printf("로그 쓰기 / db_load 실행  실패\n");
+      failures++;
+      break;
+    }
+  }
+
+  expect("옮긴 행 수", query_int(db_path, "SELECT COUNT(*) FROM ultrasonic;"), 2 * ROWS_PER_RUN);
+  expect("옮긴 세그먼트 수", query_int(db_path, "SELECT COUNT(*) FROM log_loaded;"), 2);
+  expect("서로 다른 측정 번호", query_int(db_path, "SELECT COUNT(DISTINCT measurement_num) FROM ultrasonic;"),
+         2 * ROWS_PER_RUN);
+
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", base);
+  if (system(cmd) != 0)
+  {
+    fprintf(stderr, "%s를 지우지 못함\n", base);
+  }
+
+  if (failures > 0)
+  {
+    printf("실패 %d건\n", failures);
+    return 1;
+  }
+  printf("통과\n");
+  return 0;
+}
@@ -0,0 +1,60 @@
+/*
+파일명: sample_ring.c
+작성일: 2026-10-16
+설명: 단일 생산자/단일 소비자(SPSC) 락프리 링 버퍼
+      push/pop 모두 할당과 잠금이 없고, 가득 차면 기다리지 않고 버림
+ */
+
+#include "sample_ring.h"
+
+#define RING_MASK (SAMPLE_RING_SIZE - 1)
+
+_Static_assert((SAMPLE_RING_SIZE & RING_MASK) == 0, "SAMPLE_RING_SIZE must be a power of two");
+
+// ========== 초기화 ==========
+void sample_ring_init(struct sample_ring *ring)
+{
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  atomic_init(&ring->dropped, 0);
+}
+
+// ========== 넣기 (생산자 전용) ==========
+// 가득 차 있으면 false를 돌려주고 버린 수를 셈
+bool sample_ring_push(struct sample_ring *ring, const struct sample *s)
+{
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+  if (head - tail >= SAMPLE_RING_SIZE)
+  {
+    atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+    return false;
+  }
+
+  ring->slots[head & RING_MASK] = *s;
+  atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+  return true;
+}
+
+// ========== 꺼내기 (소비자 전용) ==========
+bool sample_ring_pop(struct sample_ring *ring, struct sample *out)
+{
+  uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+  if (tail == head)
+  {
+    return false;
+  }
+
+  *out = ring->slots[tail & RING_MASK];
+  atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+// ========== 버린 레코드 수 ==========
+uint32_t sample_ring_dropped(struct sample_ring *ring)
+{
+  return atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+}
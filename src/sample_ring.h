@@ -0,0 +1,50 @@
+/*
+파일명: sample_ring.h
+작성일: 2026-10-16
+설명: 단일 생산자/단일 소비자(SPSC) 락프리 링 버퍼
+      고정 크기 측정 레코드를 스레드 사이에 블로킹 없이 전달
+ */
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define SAMPLE_RING_SIZE 256   // 슬롯 수 (2의 거듭제곱)
+#define CACHE_LINE 64
+
+// ========== 측정 레코드 ==========
+struct sample
+{
+  int64_t scheduled_ns;   // 트리거 예정 시각 (CLOCK_MONOTONIC)
+  int64_t trigger_ns;     // 실제 트리거 시각
+  int64_t rise_ns;        // 에코 상승 에지 시각 (커널 타임스탬프)
+  int64_t pulse_ns;       // 에코 펄스 폭 (버스트면 중앙값)
+  int64_t spread_ns;      // 버스트 펄스 폭의 IQR (단일 핑이면 -1)
+  double distance_cm;     // 계산된 거리 (저장용)
+  double spread_cm;       // spread_ns를 거리로 바꾼 값 (저장용, 없으면 음수)
+  int32_t status;         // US_OK 또는 타임아웃 코드
+  int32_t num;            // 측정 번호
+  int32_t ir_triggered;   // IR 감지로 시작한 측정이면 1 (연속 측정은 0)
+  int32_t pings;          // 측정값을 만든 유효 핑 수
+  int32_t sensor_id;      // 센서 배열(-A)의 센서 번호 (단일 센서는 0)
+};
+
+// ========== 링 버퍼 ==========
+// head는 생산자만, tail은 소비자만 쓰므로 서로 다른 캐시 라인에 둠
+struct sample_ring
+{
+  _Alignas(CACHE_LINE) _Atomic uint32_t head;
+  _Alignas(CACHE_LINE) _Atomic uint32_t tail;
+  _Alignas(CACHE_LINE) _Atomic uint32_t dropped;   // 가득 차서 버린 레코드 수
+  struct sample slots[SAMPLE_RING_SIZE];
+};
+
+void sample_ring_init(struct sample_ring *ring);
+bool sample_ring_push(struct sample_ring *ring, const struct sample *s);
+bool sample_ring_pop(struct sample_ring *ring, struct sample *out);
+uint32_t sample_ring_dropped(struct sample_ring *ring);
+
+#endif
@@ -0,0 +1,14 @@
+/*
+파일명: sound_speed.c
+작성일: 2026-10-16
+설명: 온도 보정 음속 계수 표
+      표 값은 빌드할 때 sound_speed_gen이 공식으로 계산해 만든 헤더에서 가져옴
+ */
+
+#include "sound_speed.h"
+
+// ========== 온도별 계수 표 (SOUND_TEMP_MIN_C ~ SOUND_TEMP_MAX_C, 1C 간격) ==========
+const uint32_t sound_speed_factor_table[SOUND_TABLE_SIZE] =
+{
+#include "sound_speed_table.h"
+};
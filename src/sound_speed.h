@@ -0,0 +1,56 @@
+/*
+파일명: sound_speed.h
+작성일: 2026-10-16
+설명: 온도 보정 음속 변환
+      에코 펄스 폭(ns) → 거리(0.1mm)를 온도별 고정소수점 계수 표로 계산
+      표(sound_speed_table.h)는 빌드할 때 sound_speed_gen이 만들고,
+      측정 경로에서는 곱셈 한 번과 시프트만 씀 (나눗셈, double 없음)
+ */
+
+#ifndef SOUND_SPEED_H
+#define SOUND_SPEED_H
+
+#include <stdint.h>
+
+// ========== 표 범위 ==========
+#define SOUND_TEMP_MIN_C (-40)       // 표 첫 온도 (C)
+#define SOUND_TEMP_MAX_C 85          // 표 마지막 온도 (C)
+#define SOUND_TABLE_SIZE (SOUND_TEMP_MAX_C - SOUND_TEMP_MIN_C + 1)
+#define SOUND_DEFAULT_TEMP_C 20      // 온도를 모를 때 (343.2 m/s, 기존 34300 cm/s와 비슷)
+
+// ========== 음속 공식 (표 생성/검증용) ==========
+// c = 331.3 * sqrt(1 + T / 273.15) m/s
+#define SOUND_SPEED_0C_M_S 331.3
+#define SOUND_KELVIN_0C 273.15
+
+// 계수 = 0.1mm/ns 단위 편도 거리(c / 2 * 1e-9 * 1e4)를 2^32배한 값
+#define SOUND_FACTOR_SHIFT 32
+#define SOUND_FACTOR_SCALE (5e-6 * 4294967296.0)
+
+extern const uint32_t sound_speed_factor_table[SOUND_TABLE_SIZE];
+
+// ========== 온도 → 표 계수 ==========
+// 표 범위 밖 온도는 양 끝 값으로 고정
+static inline uint32_t sound_speed_factor(int temp_c)
+{
+  if (temp_c < SOUND_TEMP_MIN_C)
+  {
+    temp_c = SOUND_TEMP_MIN_C;
+  }
+  else if (temp_c > SOUND_TEMP_MAX_C)
+  {
+    temp_c = SOUND_TEMP_MAX_C;
+  }
+  return sound_speed_factor_table[temp_c - SOUND_TEMP_MIN_C];
+}
+
+// ========== 펄스 폭(ns) → 편도 거리(0.1mm) ==========
+// 400cm 마감(약 25ms)에서도 곱이 2^48 안쪽이라 64비트로 넘치지 않음
+static inline int32_t sound_ns_to_01mm(int64_t pulse_ns, int temp_c)
+{
+  uint64_t product = (uint64_t)pulse_ns * sound_speed_factor(temp_c);
+
+  return (int32_t)((product + (1ULL << (SOUND_FACTOR_SHIFT - 1))) >> SOUND_FACTOR_SHIFT);
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+파일명: sound_speed_check.c
+작성일: 2026-10-16
+설명: 음속 계수 표 검증 (make check)
+      표로 계산한 거리를 음속 공식으로 double 계산한 거리와 비교
+      온도 전 범위, 측정 범위 전체의 펄스 폭에서 오차가 0.1mm 이내인지 확인
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sound_speed.h"
+
+#define MAX_ERROR_01MM 1.0     // 허용 오차 (0.1mm 단위 한 칸)
+#define PULSE_MAX_NS 30000000LL // -40C에서 400cm 왕복(약 26ms)보다 넉넉히
+
+int main(void)
+{
+  // 1us부터 30ms까지 0.367us 간격으로 훑음 (표 계수의 반올림 오차가 가장 커지는 긴 펄스 포함)
+  double max_error = 0;
+  int max_error_temp = 0;
+  int64_t max_error_pulse = 0;
+  long checked = 0;
+
+  for (int t = SOUND_TEMP_MIN_C; t <= SOUND_TEMP_MAX_C; t++)
+  {
+    double c = SOUND_SPEED_0C_M_S * sqrt(1.0 + t / SOUND_KELVIN_0C);
+
+    for (int64_t pulse_ns = 1000; pulse_ns <= PULSE_MAX_NS; pulse_ns += 367)
+    {
+      double expected = pulse_ns * 1e-9 * c / 2.0 * 1e4;
+      double error = fabs(sound_ns_to_01mm(pulse_ns, t) - expected);
+
+      if (error > max_error)
+      {
+        max_error = error;
+        max_error_temp = t;
+        max_error_pulse = pulse_ns;
+      }
+      checked++;
+    }
+  }
+
+  printf("음속 표 검증: %d ~ %d C, 펄스 %ld개 비교\n",
+         SOUND_TEMP_MIN_C, SOUND_TEMP_MAX_C, checked);
+  printf("최대 오차: %.3f x 0.1mm (%d C, 펄스 %lld ns)\n",
+         max_error, max_error_temp, (long long)max_error_pulse);
+
+  // 참고: 고정 34300 cm/s를 쓰면 계절 온도 차이로 생기는 거리 오차
+  printf("고정 음속 대비 오차: 0C %+.2f%%, 30C %+.2f%%\n",
+         (sound_ns_to_01mm(10000000, 0) / 17150.0 - 1) * 100,
+         (sound_ns_to_01mm(10000000, 30) / 17150.0 - 1) * 100);
+
+  if (max_error > MAX_ERROR_01MM)
+  {
+    printf("실패: 허용 오차 %.1f x 0.1mm 초과\n", MAX_ERROR_01MM);
+    return 1;
+  }
+  printf("통과\n");
+  return 0;
+}
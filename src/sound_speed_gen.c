@@ -0,0 +1,26 @@
+/*
+파일명: sound_speed_gen.c
+작성일: 2026-10-16
+설명: 온도 보정 음속 계수 표 생성기 (빌드 도구)
+      make가 실행해 sound_speed_table.h를 만듦
+      표 범위와 고정소수점 형식은 sound_speed.h를 그대로 따름
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sound_speed.h"
+
+int main(void)
+{
+  printf("/* 자동 생성 파일: sound_speed_gen이 만듦 (직접 수정하지 말 것) */\n");
+  printf("/* 온도(C), 음속(m/s), 계수 = 음속 * 5e-6 * 2^%d */\n", SOUND_FACTOR_SHIFT);
+
+  for (int t = SOUND_TEMP_MIN_C; t <= SOUND_TEMP_MAX_C; t++)
+  {
+    double c = SOUND_SPEED_0C_M_S * sqrt(1.0 + t / SOUND_KELVIN_0C);
+
+    printf("  %10luu, /* %4d C  %.2f m/s */\n",
+           (unsigned long)lround(c * SOUND_FACTOR_SCALE), t, c);
+  }
+  return 0;
+}
@@ -0,0 +1,669 @@
+/*
+파일명: storage.c
+작성일: 2026-10-16
+설명: 초음파 측정값 SQLite 저장 모듈
+      SQL 문자열을 매번 만들어 sqlite3_exec하면 행마다 파싱/계획을 다시 하므로
+      준비된 문장에 값을 바인딩해 실행 (거리도 %.2f 반올림 없이 그대로 저장)
+      압축 스키마는 같은 레코드를 ns 키 + 0.1mm 정수로 samples 테이블에 저장
+      행마다 분/시간 요약 행도 같은 트랜잭션에서 UPSERT로 갱신
+      파티션 모드는 측정 시각이 다음 구간으로 넘어가면 파일을 닫고 새 파일을 엶
+      (요약 테이블도 파일마다 따로 있어 통계는 파일들을 ATTACH해 합침)
+      바이너리 로그 모드는 같은 레코드를 sample_log에 추가만 함 (db_load로 나중에 옮김)
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <sys/stat.h>
+#include "storage.h"
+#include "vfs_sync_count.h"
+#include "event_loop.h"
+
+static int open_db(struct storage *st);
+static void close_db(struct storage *st);
+static int open_partition(struct storage *st, int64_t epoch_s);
+static void enforce_budget(struct storage *st, int64_t epoch_s);
+static int append_log(struct storage *st, const struct sample *s);
+static void add_latency(struct storage *st, int64_t start_ns);
+static int exec_pragma(sqlite3 *db, const char *name, const char *value);
+static int step_once(struct storage *st, sqlite3_stmt *stmt);
+static void rollback(struct storage *st);
+static int undo_row(struct storage *st);
+static int add_column(sqlite3 *db, const char *name, const char *type);
+static int create_tables(struct storage *st);
+static void bind_legacy(struct storage *st, const struct sample *s);
+static void bind_compact(struct storage *st, const struct sample *s);
+static int64_t epoch_offset_ns(void);
+static int backfill_rollup(sqlite3 *db, bool compact, const char *table, int bucket_s);
+static int update_rollup(struct storage *st, sqlite3_stmt *stmt, int64_t bucket,
+                         int64_t distance_01mm, int ir_triggered);
+
+// ========== 저장소 열기 ==========
+// 파티션 모드면 path는 디렉터리 (없으면 만듦), 지금 시각의 파티션 파일을 엶
+int storage_open(struct storage *st, const char *path,
+                 const struct storage_config *config)
+{
+  st->db = NULL;
+  st->insert_stmt = NULL;
+  st->begin_stmt = NULL;
+  st->commit_stmt = NULL;
+  st->savepoint_stmt = NULL;
+  st->release_stmt = NULL;
+  st->undo_stmt = NULL;
+  st->minute_stmt = NULL;
+  st->hour_stmt = NULL;
+  st->config = *config;
+  st->batching = (config->batch_rows > 1 || config->batch_ms > 0);
+  st->batch_count = 0;
+  st->epoch_offset_ns = epoch_offset_ns();
+  st->opened_ns = monotonic_ns();
+  st->commit_count = 0;
+  st->insert_count = 0;
+  st->insert_errors = 0;
+  st->insert_total_ns = 0;
+  st->insert_max_ns = 0;
+  st->dropped_rows = 0;
+  st->partition = -1;
+  st->rotate_count = 0;
+  st->removed_count = 0;
+  st->enforce_s = 0;
+
+  // fsync 횟수를 세기 위해 감싼 VFS로 열기 (파티션을 바꿔도 카운터는 이어짐)
+  vfs_sync_count_register();
+  st->sync_base = vfs_sync_count_get();
+
+  if (config->log_records > 0)
+  {
+    st->dir[0] = '\0';
+    snprintf(st->path, sizeof(st->path), "%s", path);
+    return sample_log_open(&st->log, path, config->log_records);
+  }
+
+  if (config->partition_s <= 0)
+  {
+    st->dir[0] = '\0';
+    snprintf(st->path, sizeof(st->path), "%s", path);
+    return open_db(st);
+  }
+
+  snprintf(st->dir, sizeof(st->dir), "%s", path);
+  if (mkdir(st->dir, 0755) < 0 && errno != EEXIST)
+  {
+    perror(st->dir);
+    return -1;
+  }
+  return open_partition(st, (st->opened_ns + st->epoch_offset_ns) / 1000000000LL);
+}
+
+// ========== DB 파일 열기 + 테이블 생성 + INSERT 준비 ==========
+static int open_db(struct storage *st)
+{
+  const char *insert_sql =
+      "INSERT INTO ultrasonic(measurement_num, distance, ir_triggered, distance_spread, sensor_id) "
+      "VALUES(?, ?, ?, ?, ?);";
+  const char *compact_insert_sql =
+      "INSERT INTO samples(ts_ns, sensor_id, distance_01mm, spread_01mm, measurement_num, ir_triggered) "
+      "VALUES(?, ?, ?, ?, ?, ?);";
+  const struct storage_config *config = &st->config;
+
+  if (sqlite3_open_v2(st->path, &st->db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                      VFS_SYNC_COUNT_NAME) != SQLITE_OK)
+  {
+    fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(st->db));
+    close_db(st);
+    return -1;
+  }
+
+  // 다른 프로세스가 DB를 잠그고 있으면 최대 5초 재시도 (쓰기 스레드만 기다림)
+  sqlite3_busy_timeout(st->db, 5000);
+
+  // 묶음 모드는 WAL 저널 사용 (커밋이 WAL 끝에 추가만 하므로 fsync가 적음)
+  if (st->batching && exec_pragma(st->db, "journal_mode", "WAL") < 0)
+  {
+    close_db(st);
+    return -1;
+  }
+  if (config->synchronous != NULL &&
+      exec_pragma(st->db, "synchronous", config->synchronous) < 0)
+  {
+    close_db(st);
+    return -1;
+  }
+
+  if (create_tables(st) < 0 || storage_create_rollups(st->db, st->config.compact) < 0)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(st->db));
+    close_db(st);
+    return -1;
+  }
+
+  if (sqlite3_prepare_v2(st->db, config->compact ? compact_insert_sql : insert_sql, -1,
+                         &st->insert_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, "BEGIN;", -1, &st->begin_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, "COMMIT;", -1, &st->commit_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, "SAVEPOINT row;", -1, &st->savepoint_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, "RELEASE row;", -1, &st->release_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, "ROLLBACK TO row;", -1, &st->undo_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, STORAGE_ROLLUP_UPSERT_SQL("rollup_minute"), -1,
+                         &st->minute_stmt, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(st->db, STORAGE_ROLLUP_UPSERT_SQL("rollup_hour"), -1,
+                         &st->hour_stmt, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(st->db));
+    close_db(st);
+    return -1;
+  }
+
+  return 0;
+}
+
+// ========== 측정값 한 행 저장 ==========
+// 원본 행과 분/시간 요약 갱신은 한 트랜잭션 (묶음 모드는 묶음 단위, 아니면 행 단위)
+// 행 하나는 SAVEPOINT로 감싸 셋 중 하나라도 실패하면 그 행만 통째로 빠짐
+int storage_insert(struct storage *st, const struct sample *s)
+{
+  int64_t start_ns = monotonic_ns();
+  int64_t ts_s;
+  int64_t distance_01mm = llround(s->distance_cm * 100.0);
+  int rc;
+
+  // RTC 없는 Pi는 보통 NTP 동기화 전에 시작하므로 보정값은 행마다 다시 구함 (vDSO 호출 두 번)
+  // 압축 키, 요약 구간, 파티션 이름/나이, 바이너리 로그 시각이 모두 이 값을 씀
+  st->epoch_offset_ns = epoch_offset_ns();
+  ts_s = (s->trigger_ns + st->epoch_offset_ns) / 1000000000LL;
+
+  if (st->config.log_records > 0)
+  {
+    rc = append_log(st, s);
+    add_latency(st, start_ns);
+    return rc;
+  }
+
+  // 측정 시각이 다음 구간이면 파일을 바꿈 (시계가 되돌아가면 지금 파일에 계속 씀)
+  if (st->config.partition_s > 0 &&
+      partition_index(ts_s, st->config.partition_s) > st->partition)
+  {
+    if (st->partition >= 0)
+    {
+      close_db(st);
+      st->rotate_count++;
+    }
+    if (open_partition(st, ts_s) < 0)
+    {
+      st->insert_errors++;
+      return -1;
+    }
+  }
+  else if (st->config.partition_s > 0 && ts_s >= st->enforce_s)
+  {
+    // 구간이 길면(기본 하루) 파일을 바꾸기 전에도 예산을 넘을 수 있어 주기적으로 다시 검사
+    enforce_budget(st, ts_s);
+  }
+
+  // 묶음의 첫 행이면 (행마다 커밋하면 매번) 트랜잭션 시작
+  if ((!st->batching || st->batch_count == 0) && step_once(st, st->begin_stmt) < 0)
+  {
+    st->insert_errors++;
+    return -1;
+  }
+
+  if (step_once(st, st->savepoint_stmt) < 0)
+  {
+    st->insert_errors++;
+    rc = SQLITE_ERROR;
+  }
+  else
+  {
+    if (st->config.compact)
+    {
+      bind_compact(st, s);
+    }
+    else
+    {
+      bind_legacy(st, s);
+    }
+
+    rc = sqlite3_step(st->insert_stmt);
+    if (rc != SQLITE_DONE)
+    {
+      fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(st->db));
+    }
+    sqlite3_reset(st->insert_stmt);
+
+    // 요약만 빠진 원본 행이 커밋되면 db_stats가 읽는 요약과 원본이 영원히 어긋나므로 행째 되돌림
+    if (rc == SQLITE_DONE &&
+        (update_rollup(st, st->minute_stmt, ts_s / STORAGE_ROLLUP_MINUTE_S,
+                       distance_01mm, s->ir_triggered) < 0 ||
+         update_rollup(st, st->hour_stmt, ts_s / STORAGE_ROLLUP_HOUR_S,
+                       distance_01mm, s->ir_triggered) < 0))
+    {
+      rc = SQLITE_ERROR;
+    }
+
+    if (rc != SQLITE_DONE)
+    {
+      st->insert_errors++;
+      if (undo_row(st) < 0)
+      {
+        add_latency(st, start_ns);
+        return -1;
+      }
+    }
+    else if (step_once(st, st->release_stmt) < 0)
+    {
+      st->insert_errors++;
+      rc = SQLITE_ERROR;
+    }
+  }
+
+  if (st->batching)
+  {
+    st->batch_count++;
+    if (st->config.batch_rows > 1 && st->batch_count >= st->config.batch_rows &&
+        storage_flush(st) < 0)
+    {
+      rc = SQLITE_ERROR;   // 이 행도 버린 묶음에 들어 있음
+    }
+  }
+  else if (step_once(st, st->commit_stmt) == 0)
+  {
+    st->commit_count++;
+  }
+  else
+  {
+    // 행 단위 커밋도 실패하면 되돌려야 다음 BEGIN이 "트랜잭션 안의 트랜잭션"으로 막히지 않음
+    rollback(st);
+    st->dropped_rows++;
+    rc = SQLITE_ERROR;
+  }
+
+  add_latency(st, start_ns);
+  return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+// ========== 바이너리 로그에 한 레코드 추가 ==========
+static int append_log(struct storage *st, const struct sample *s)
+{
+  struct sample_log_record rec;
+
+  rec.ts_ns = s->trigger_ns + st->epoch_offset_ns;
+  rec.distance_01mm = llround(s->distance_cm * 100.0);
+  rec.spread_01mm = (s->spread_cm >= 0) ? llround(s->spread_cm * 100.0) : -1;
+  rec.num = s->num;
+  rec.sensor_id = s->sensor_id;
+  rec.flags = s->ir_triggered ? SAMPLE_LOG_FLAG_IR : 0;
+  if (sample_log_append(&st->log, &rec) < 0)
+  {
+    st->insert_errors++;
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 삽입 지연 누적 ==========
+static void add_latency(struct storage *st, int64_t start_ns)
+{
+  int64_t elapsed_ns = monotonic_ns() - start_ns;
+
+  st->insert_count++;
+  st->insert_total_ns += elapsed_ns;
+  if (elapsed_ns > st->insert_max_ns)
+  {
+    st->insert_max_ns = elapsed_ns;
+  }
+}
+
+// ========== 열린 묶음 커밋 ==========
+// 쌓인 행이 없으면 아무것도 하지 않음
+// COMMIT이 실패하면(예: 다른 프로세스가 busy_timeout보다 오래 잠금) 트랜잭션을 되돌려
+// 다음 묶음이 BEGIN부터 다시 시작할 수 있게 하고, 그 묶음의 행은 버린 것으로 셈
+int storage_flush(struct storage *st)
+{
+  if (!st->batching || st->batch_count == 0)
+  {
+    return 0;
+  }
+
+  if (step_once(st, st->commit_stmt) < 0)
+  {
+    fprintf(stderr, "DB 묶음 커밋 실패: %d행 버림\n", st->batch_count);
+    rollback(st);
+    st->dropped_rows += st->batch_count;
+    st->batch_count = 0;
+    return -1;
+  }
+  st->batch_count = 0;
+  st->commit_count++;
+  return 0;
+}
+
+// ========== 삽입 지연 / 처리량 통계 출력 ==========
+void storage_print_stats(const struct storage *st)
+{
+  double elapsed_s = (monotonic_ns() - st->opened_ns) / 1e9;
+  uint64_t syncs = vfs_sync_count_get() - st->sync_base;
+
+  if (st->insert_count == 0 || elapsed_s <= 0)
+  {
+    return;
+  }
+
+  printf("DB 삽입: %llu건 (실패 %llu건), 평균 %.1f us, 최대 %.1f us\n",
+         (unsigned long long)st->insert_count,
+         (unsigned long long)st->insert_errors,
+         st->insert_total_ns / 1000.0 / st->insert_count,
+         st->insert_max_ns / 1000.0);
+  if (st->dropped_rows > 0)
+  {
+    printf("DB 커밋 실패로 버린 행: %llu건\n", (unsigned long long)st->dropped_rows);
+  }
+  if (st->config.log_records > 0)
+  {
+    // 닫지 않은 현재 세그먼트도 종료 때 msync 한 번으로 내림
+    printf("바이너리 로그: %.2f rows/s, 세그먼트 %llu개 닫음, msync %llu회\n",
+           st->insert_count / elapsed_s, (unsigned long long)st->log.segments,
+           (unsigned long long)st->log.msyncs);
+    return;
+  }
+  printf("DB 처리량: %.2f rows/s, 커밋 %llu회, fsync %llu회 (%.2f fsyncs/s)\n",
+         st->insert_count / elapsed_s,
+         (unsigned long long)st->commit_count,
+         (unsigned long long)syncs, syncs / elapsed_s);
+  if (st->config.partition_s > 0)
+  {
+    printf("DB 파티션: %s, 교체 %llu회, 예산 초과로 삭제 %llu개\n", st->path,
+           (unsigned long long)st->rotate_count, (unsigned long long)st->removed_count);
+  }
+}
+
+// ========== 닫기 ==========
+void storage_close(struct storage *st)
+{
+  if (st->config.log_records > 0)
+  {
+    sample_log_close(&st->log);
+    return;
+  }
+  close_db(st);
+}
+
+// ========== 요약 테이블 생성 ==========
+// 처음 만들 때는 이미 쌓인 원본 행으로 한 번 채움 (이후에는 삽입마다 갱신)
+// 요약 없이 쌓인 DB를 db_stats가 읽을 때도 같은 함수로 만듦
+// 이미 있으면 0, 새로 만들어 채웠으면 1, 실패하면 -1
+int storage_create_rollups(sqlite3 *db, bool compact)
+{
+  sqlite3_stmt *probe = NULL;
+  bool exists = (sqlite3_prepare_v2(db, "SELECT bucket FROM rollup_minute LIMIT 0;",
+                                    -1, &probe, NULL) == SQLITE_OK);
+
+  sqlite3_finalize(probe);
+  if (exists)
+  {
+    return 0;
+  }
+
+  if (sqlite3_exec(db, "BEGIN;", 0, 0, NULL) != SQLITE_OK)
+  {
+    return -1;
+  }
+  if (sqlite3_exec(db, STORAGE_ROLLUP_TABLE_SQL("rollup_minute"), 0, 0, NULL) != SQLITE_OK ||
+      sqlite3_exec(db, STORAGE_ROLLUP_TABLE_SQL("rollup_hour"), 0, 0, NULL) != SQLITE_OK ||
+      backfill_rollup(db, compact, "rollup_minute", STORAGE_ROLLUP_MINUTE_S) < 0 ||
+      backfill_rollup(db, compact, "rollup_hour", STORAGE_ROLLUP_HOUR_S) < 0)
+  {
+    sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+    return -1;
+  }
+  return (sqlite3_exec(db, "COMMIT;", 0, 0, NULL) == SQLITE_OK) ? 1 : -1;
+}
+
+// ========== 파티션 파일 열기 + 보관 예산 적용 ==========
+// 실패하면 partition을 -1로 두어 다음 행에서 다시 열기를 시도
+static int open_partition(struct storage *st, int64_t epoch_s)
+{
+  st->partition = partition_index(epoch_s, st->config.partition_s);
+  partition_path(st->path, sizeof(st->path), st->dir, st->partition, st->config.partition_s);
+  if (open_db(st) < 0)
+  {
+    st->partition = -1;
+    return -1;
+  }
+  enforce_budget(st, epoch_s);
+  return 0;
+}
+
+// ========== 보관 예산 적용 ==========
+// 파티션을 열 때와 그 뒤 PARTITION_ENFORCE_S마다 호출 (디렉터리 목록 + stat만 하므로 가벼움)
+static void enforce_budget(struct storage *st, int64_t epoch_s)
+{
+  int removed;
+
+  // 지금 파일보다 오래된 파티션만 지우므로 쓰는 중인 파일은 건드리지 않음
+  removed = partition_enforce(st->dir, st->path, st->config.partition_s,
+                              &st->config.budget, epoch_s);
+  if (removed > 0)
+  {
+    st->removed_count += removed;
+  }
+  st->enforce_s = epoch_s + PARTITION_ENFORCE_S;
+}
+
+// ========== DB 파일 닫기 ==========
+static void close_db(struct storage *st)
+{
+  // 종료 전에 남은 묶음을 먼저 커밋
+  if (st->commit_stmt != NULL)
+  {
+    storage_flush(st);
+  }
+
+  sqlite3_finalize(st->insert_stmt);
+  sqlite3_finalize(st->begin_stmt);
+  sqlite3_finalize(st->commit_stmt);
+  sqlite3_finalize(st->savepoint_stmt);
+  sqlite3_finalize(st->release_stmt);
+  sqlite3_finalize(st->undo_stmt);
+  sqlite3_finalize(st->minute_stmt);
+  sqlite3_finalize(st->hour_stmt);
+  st->insert_stmt = NULL;
+  st->begin_stmt = NULL;
+  st->commit_stmt = NULL;
+  st->savepoint_stmt = NULL;
+  st->release_stmt = NULL;
+  st->undo_stmt = NULL;
+  st->minute_stmt = NULL;
+  st->hour_stmt = NULL;
+
+  if (st->db != NULL)
+  {
+    sqlite3_close(st->db);
+    st->db = NULL;
+  }
+}
+
+// ========== 기존 스키마 바인딩 ==========
+// spread가 음수면 (단일 핑) distance_spread는 NULL
+// sensor_id는 센서 배열(-A)의 센서 번호, 단일 센서는 0
+static void bind_legacy(struct storage *st, const struct sample *s)
+{
+  sqlite3_bind_int(st->insert_stmt, 1, s->num);
+  sqlite3_bind_double(st->insert_stmt, 2, s->distance_cm);
+  sqlite3_bind_int(st->insert_stmt, 3, s->ir_triggered);
+  if (s->spread_cm >= 0)
+  {
+    sqlite3_bind_double(st->insert_stmt, 4, s->spread_cm);
+  }
+  else
+  {
+    sqlite3_bind_null(st->insert_stmt, 4);
+  }
+  sqlite3_bind_int(st->insert_stmt, 5, s->sensor_id);
+}
+
+// ========== 압축 스키마 바인딩 ==========
+// 키는 트리거 시각을 epoch ns로 옮긴 값 (같은 슬롯의 배열 센서는 sensor_id로 구분)
+// 거리는 음속 표의 0.1mm 정수로 되돌려 저장 (cm 값은 그 정수 * 0.01)
+static void bind_compact(struct storage *st, const struct sample *s)
+{
+  sqlite3_bind_int64(st->insert_stmt, 1, s->trigger_ns + st->epoch_offset_ns);
+  sqlite3_bind_int(st->insert_stmt, 2, s->sensor_id);
+  sqlite3_bind_int64(st->insert_stmt, 3, llround(s->distance_cm * 100.0));
+  if (s->spread_cm >= 0)
+  {
+    sqlite3_bind_int64(st->insert_stmt, 4, llround(s->spread_cm * 100.0));
+  }
+  else
+  {
+    sqlite3_bind_null(st->insert_stmt, 4);
+  }
+  sqlite3_bind_int(st->insert_stmt, 5, s->num);
+  sqlite3_bind_int(st->insert_stmt, 6, s->ir_triggered);
+}
+
+// ========== 테이블 생성 ==========
+// 압축 스키마는 samples만, 기존 스키마는 ultrasonic + 나중에 생긴 열
+static int create_tables(struct storage *st)
+{
+  if (st->config.compact)
+  {
+    return (sqlite3_exec(st->db, STORAGE_COMPACT_TABLE_SQL, 0, 0, NULL) == SQLITE_OK) ? 0 : -1;
+  }
+
+  if (sqlite3_exec(st->db, STORAGE_LEGACY_TABLE_SQL, 0, 0, NULL) != SQLITE_OK ||
+      add_column(st->db, "distance_spread", "REAL") < 0 ||
+      add_column(st->db, "sensor_id", "INT DEFAULT 0") < 0)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 기존 원본 행으로 요약 채우기 ==========
+// 기존 스키마의 시각은 timestamp(초), 압축 스키마는 ts_ns
+static int backfill_rollup(sqlite3 *db, bool compact, const char *table, int bucket_s)
+{
+  char sql[512];
+
+  if (compact)
+  {
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO %s SELECT ts_ns / %lld AS b, COUNT(*), SUM(distance_01mm), "
+             "SUM(distance_01mm * distance_01mm), MIN(distance_01mm), MAX(distance_01mm), "
+             "SUM(COALESCE(ir_triggered, 0)) FROM samples GROUP BY b;",
+             table, bucket_s * 1000000000LL);
+  }
+  else
+  {
+    snprintf(sql, sizeof(sql),
+             "INSERT INTO %s SELECT CAST(strftime('%%s', timestamp) AS INTEGER) / %d AS b, "
+             "COUNT(*), SUM(d), SUM(d * d), MIN(d), MAX(d), SUM(COALESCE(ir_triggered, 0)) "
+             "FROM (SELECT timestamp, CAST(round(distance * 100) AS INTEGER) AS d, ir_triggered "
+             "FROM ultrasonic WHERE distance IS NOT NULL AND timestamp IS NOT NULL) GROUP BY b;",
+             table, bucket_s);
+  }
+  return (sqlite3_exec(db, sql, 0, 0, NULL) == SQLITE_OK) ? 0 : -1;
+}
+
+// ========== 요약 행 하나 갱신 ==========
+static int update_rollup(struct storage *st, sqlite3_stmt *stmt, int64_t bucket,
+                         int64_t distance_01mm, int ir_triggered)
+{
+  int rc;
+
+  sqlite3_bind_int64(stmt, 1, bucket);
+  sqlite3_bind_int64(stmt, 2, distance_01mm);
+  sqlite3_bind_int(stmt, 3, ir_triggered);
+  rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  if (rc != SQLITE_DONE)
+  {
+    fprintf(stderr, "SQL error (rollup): %s\n", sqlite3_errmsg(st->db));
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 단조 시계 → epoch 보정값 ==========
+// 두 시계를 연달아 읽어 차이만 구함 (storage_insert가 행마다 불러 NTP 보정을 따라감)
+static int64_t epoch_offset_ns(void)
+{
+  struct timespec real, mono;
+
+  clock_gettime(CLOCK_REALTIME, &real);
+  clock_gettime(CLOCK_MONOTONIC, &mono);
+  return (real.tv_sec - mono.tv_sec) * 1000000000LL + (real.tv_nsec - mono.tv_nsec);
+}
+
+// ========== PRAGMA 실행 ==========
+static int exec_pragma(sqlite3 *db, const char *name, const char *value)
+{
+  char sql[64];
+
+  snprintf(sql, sizeof(sql), "PRAGMA %s=%s;", name, value);
+  return storage_exec(db, sql);
+}
+
+// ========== 나중에 생긴 열 추가 ==========
+// 그 열이 생기기 전에 만든 ultrasonic.db도 그대로 열 수 있게 없을 때만 추가
+// (distance_spread: 버스트 IQR, sensor_id: 센서 배열 번호)
+static int add_column(sqlite3 *db, const char *name, const char *type)
+{
+  sqlite3_stmt *probe = NULL;
+  char sql[128];
+
+  snprintf(sql, sizeof(sql), "SELECT %s FROM ultrasonic LIMIT 0;", name);
+  if (sqlite3_prepare_v2(db, sql, -1, &probe, NULL) == SQLITE_OK)
+  {
+    sqlite3_finalize(probe);
+    return 0;
+  }
+  snprintf(sql, sizeof(sql), "ALTER TABLE ultrasonic ADD COLUMN %s %s;", name, type);
+  if (sqlite3_exec(db, sql, 0, 0, NULL) != SQLITE_OK)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 결과 없는 준비된 문장 실행 (BEGIN/COMMIT) ==========
+static int step_once(struct storage *st, sqlite3_stmt *stmt)
+{
+  int rc = sqlite3_step(stmt);
+
+  sqlite3_reset(stmt);
+  if (rc != SQLITE_DONE)
+  {
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(st->db));
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 열린 트랜잭션 되돌리기 ==========
+// 실패한 COMMIT은 트랜잭션을 열어 둔 채 돌아오므로 명시적으로 ROLLBACK
+static void rollback(struct storage *st)
+{
+  if (!sqlite3_get_autocommit(st->db) &&
+      sqlite3_exec(st->db, "ROLLBACK;", 0, 0, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "SQL error (ROLLBACK): %s\n", sqlite3_errmsg(st->db));
+  }
+}
+
+// ========== 한 행 되돌리기 ==========
+// SAVEPOINT 뒤(이번 행의 INSERT와 요약 갱신)만 되돌리고 묶음의 앞 행은 남김
+// 오류로 SQLite가 트랜잭션 전체를 이미 되돌렸으면 묶음의 행은 모두 버린 것으로 세고 -1
+static int undo_row(struct storage *st)
+{
+  if (sqlite3_get_autocommit(st->db))
+  {
+    st->dropped_rows += st->batch_count;
+    st->batch_count = 0;
+    return -1;
+  }
+  step_once(st, st->undo_stmt);
+  step_once(st, st->release_stmt);
+  return 0;
+}
@@ -0,0 +1,147 @@
+/*
+파일명: storage.h
+작성일: 2026-10-16
+설명: 초음파 측정값 SQLite 저장 모듈
+      INSERT 문은 한 번만 준비(prepare)하고 행마다 bind → step → reset
+      묶음 모드: N행 또는 T밀리초마다 한 트랜잭션으로 커밋 (WAL 저널)
+      압축 스키마: ns 정수 키 + WITHOUT ROWID + 0.1mm 정수 거리 (samples 테이블)
+      분/시간 요약(rollup) 행을 원본 행과 같은 트랜잭션에서 갱신 (통계는 요약만 읽음)
+      파티션 모드: 구간(기본 하루)마다 DB 파일을 바꾸고 예산을 넘은 파일은 통째로 삭제
+      바이너리 로그 모드: SQLite 대신 mmap 세그먼트 파일에 고정 크기 레코드를 추가만 함
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sqlite3.h>
+#include "sample_ring.h"
+#include "partition.h"
+#include "sample_log.h"
+
+// ========== 테이블 정의 (db_migrate, db_bench와 공유) ==========
+// 기존 스키마: 자동 증가 id + 1초 해상도 DATETIME + REAL 거리
+#define STORAGE_LEGACY_TABLE_SQL \
+  "CREATE TABLE IF NOT EXISTS ultrasonic(" \
+  "id INTEGER PRIMARY KEY AUTOINCREMENT, " \
+  "measurement_num INT, " \
+  "distance REAL, " \
+  "ir_triggered BOOL, " \
+  "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP, " \
+  "distance_spread REAL, " \
+  "sensor_id INT DEFAULT 0);"
+
+// 압축 스키마: 트리거 시각(유닉스 epoch ns)과 센서 번호가 곧 기본 키
+// WITHOUT ROWID라 행이 키 순서로 B-tree에 바로 들어가고 sqlite_sequence 갱신도 없음
+// 거리와 IQR은 음속 표가 내놓는 0.1mm 정수 그대로
+#define STORAGE_COMPACT_TABLE_SQL \
+  "CREATE TABLE IF NOT EXISTS samples(" \
+  "ts_ns INTEGER NOT NULL, " \
+  "sensor_id INTEGER NOT NULL, " \
+  "distance_01mm INTEGER NOT NULL, " \
+  "spread_01mm INTEGER, " \
+  "measurement_num INTEGER, " \
+  "ir_triggered INTEGER, " \
+  "PRIMARY KEY(ts_ns, sensor_id)) WITHOUT ROWID;"
+
+// 요약 테이블: bucket은 epoch 초를 구간 길이(60 / 3600)로 나눈 값
+// 거리 합/제곱합/최소/최대는 0.1mm 정수 (합이 정확해 평균/표준편차가 누적 오차 없음)
+#define STORAGE_ROLLUP_MINUTE_S 60
+#define STORAGE_ROLLUP_HOUR_S 3600
+#define STORAGE_ROLLUP_TABLE_SQL(name) \
+  "CREATE TABLE IF NOT EXISTS " name "(" \
+  "bucket INTEGER PRIMARY KEY, " \
+  "count INTEGER NOT NULL, " \
+  "sum INTEGER NOT NULL, " \
+  "sum_sq INTEGER NOT NULL, " \
+  "min INTEGER NOT NULL, " \
+  "max INTEGER NOT NULL, " \
+  "ir_hits INTEGER NOT NULL) WITHOUT ROWID;"
+
+// 구간의 첫 행이면 새 요약 행, 아니면 누적 (SQLite 3.24 이상)
+// ?1 bucket, ?2 거리(0.1mm), ?3 IR 여부
+#define STORAGE_ROLLUP_UPSERT_SQL(name) \
+  "INSERT INTO " name "(bucket, count, sum, sum_sq, min, max, ir_hits) " \
+  "VALUES(?1, 1, ?2, ?2 * ?2, ?2, ?2, ?3) " \
+  "ON CONFLICT(bucket) DO UPDATE SET count = count + 1, sum = sum + excluded.sum, " \
+  "sum_sq = sum_sq + excluded.sum_sq, min = min(min, excluded.min), " \
+  "max = max(max, excluded.max), ir_hits = ir_hits + excluded.ir_hits;"
+
+// ========== 결과 없는 SQL 실행 (DB 도구와 공유) ==========
+// 실패하면 SQL과 SQLite 오류를 stderr에 찍고 -1
+static inline int storage_exec(sqlite3 *db, const char *sql)
+{
+  if (sqlite3_exec(db, sql, 0, 0, NULL) != SQLITE_OK)
+  {
+    fprintf(stderr, "SQL error (%s): %s\n", sql, sqlite3_errmsg(db));
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 저장 설정 ==========
+// batch_rows <= 1 이고 batch_ms == 0 이면 행마다 바로 커밋 (기존 동작)
+// batch_rows <= 1 이고 batch_ms > 0 이면 행 수 제한 없이 시간 창으로만 커밋
+struct storage_config
+{
+  int batch_rows;            // 1보다 크면 이 행 수가 쌓일 때 커밋 (0, 1: 행 수 제한 없음)
+  int batch_ms;              // 첫 행 이후 이 시간이 지나면 커밋 (타이머에서 storage_flush 호출)
+  const char *synchronous;   // PRAGMA synchronous 값 (OFF, NORMAL, FULL), NULL이면 기본값
+  bool compact;              // true면 압축 스키마(samples)에 저장
+  int partition_s;           // 0보다 크면 storage_open의 경로는 디렉터리, 이 초마다 새 DB 파일
+  struct partition_budget budget;   // 파티션 보관 예산 (크기 / 나이)
+  uint32_t log_records;      // 0보다 크면 storage_open의 경로는 바이너리 로그 디렉터리 (세그먼트당 레코드 수)
+};
+
+// ========== 저장소 상태 ==========
+struct storage
+{
+  sqlite3 *db;
+  sqlite3_stmt *insert_stmt;   // 준비된 INSERT 문 (재사용)
+  sqlite3_stmt *begin_stmt;    // BEGIN
+  sqlite3_stmt *commit_stmt;   // COMMIT
+  sqlite3_stmt *savepoint_stmt;  // SAVEPOINT row (행 하나: 원본 + 요약)
+  sqlite3_stmt *release_stmt;    // RELEASE row
+  sqlite3_stmt *undo_stmt;       // ROLLBACK TO row
+  sqlite3_stmt *minute_stmt;   // rollup_minute 갱신 (UPSERT)
+  sqlite3_stmt *hour_stmt;     // rollup_hour 갱신 (UPSERT)
+
+  struct storage_config config;
+  bool batching;               // 묶음 모드 여부
+  int batch_count;             // 현재 열린 트랜잭션에 쌓인 행 수
+  int64_t epoch_offset_ns;     // CLOCK_REALTIME - CLOCK_MONOTONIC (행마다 다시 구함, 압축 키 계산)
+
+  // 파티션 모드 상태
+  char dir[PARTITION_PATH_MAX];    // 파티션 디렉터리
+  char path[PARTITION_PATH_MAX];   // 지금 쓰는 DB 파일
+  int64_t partition;               // 지금 쓰는 파티션 번호 (-1: 다시 열어야 함)
+  uint64_t rotate_count;           // 새 파티션으로 바꾼 횟수
+  uint64_t removed_count;          // 예산 때문에 지운 파티션 수
+  int64_t enforce_s;               // 다음 예산 검사 시각 (epoch 초, 구간 안에서도 주기적으로)
+
+  struct sample_log log;           // 바이너리 로그 모드 (SQLite는 열지 않음)
+
+  // 처리량 통계
+  int64_t opened_ns;
+  uint64_t commit_count;
+  uint64_t sync_base;          // 열 때의 fsync 카운터 값
+
+  // 삽입 지연 통계 (bind ~ reset 구간)
+  uint64_t insert_count;
+  uint64_t insert_errors;
+  int64_t insert_total_ns;
+  int64_t insert_max_ns;
+  uint64_t dropped_rows;       // COMMIT 실패로 되돌린 행 수
+};
+
+int storage_open(struct storage *st, const char *path,
+                 const struct storage_config *config);
+int storage_insert(struct storage *st, const struct sample *s);
+int storage_flush(struct storage *st);
+void storage_print_stats(const struct storage *st);
+void storage_close(struct storage *st);
+int storage_create_rollups(sqlite3 *db, bool compact);
+
+#endif
@@ -0,0 +1,289 @@
+/*
+파일명: ultrasonic.c
+작성일: 2026-10-16
+설명: HC-SR04 초음파 센서 측정 모듈
+      usleep(1) 폴링 대신 에코 라인의 에지 이벤트를 기다리므로
+      측정 중 CPU를 거의 쓰지 않고, 스케줄러 지연이 거리값에 섞이지 않음
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include "ultrasonic.h"
+#include "event_loop.h"
+
+static int64_t timespec_diff_ns(const struct timespec *a, const struct timespec *b);
+static int measure_events(struct ultrasonic *us, int64_t *pulse_ns);
+static int measure_poll(struct ultrasonic *us, int64_t *pulse_ns);
+static int record_result(struct ultrasonic *us, int64_t *pulse_ns);
+
+// ========== 초기화 ==========
+// trig는 이미 출력으로 요청된 라인이어야 함
+// 에코 라인은 양방향 에지 이벤트로 요청하고, 실패하면 폴링 입력으로 대체
+int ultrasonic_init(struct ultrasonic *us, struct gpiod_line *trig,
+                    struct gpiod_line *echo)
+{
+  us->trig = trig;
+  us->echo = echo;
+  us->deadline_ns = ultrasonic_deadline_ns(US_MAX_RANGE_CM);
+  us->use_events = true;
+  us->event_count = 0;
+  us->trigger_ns = 0;
+  us->rise_ns = 0;
+
+  if (gpiod_line_request_both_edges_events(echo, "echo") == 0)
+  {
+    return 0;
+  }
+
+  perror("Echo edge events unavailable, falling back to polling");
+  us->use_events = false;
+  return gpiod_line_request_input(echo, "echo");
+}
+
+// ========== 해제 ==========
+void ultrasonic_release(struct ultrasonic *us)
+{
+  gpiod_line_release(us->echo);
+}
+
+// ========== 최대 거리로부터 대기 마감 시간 계산 ==========
+// 왕복 시간(2 * 거리 / 음속) + 에코 상승까지의 여유
+// 400cm 기준 약 23.3ms + 2ms
+int64_t ultrasonic_deadline_ns(double max_range_cm)
+{
+  return (int64_t)(2.0 * max_range_cm / US_SOUND_SPEED_CM_S * 1e9) + US_ECHO_RISE_MARGIN_NS;
+}
+
+// ========== 측정 1회 ==========
+// 성공 시 US_OK와 함께 에코 펄스 폭(ns)을 돌려줌
+int ultrasonic_measure(struct ultrasonic *us, int64_t *pulse_ns)
+{
+  if (us->use_events)
+  {
+    return measure_events(us, pulse_ns);
+  }
+  return measure_poll(us, pulse_ns);
+}
+
+// ========== 이벤트 배열 해석 ==========
+// 첫 상승 에지와 그 뒤 첫 하강 에지의 타임스탬프 차이가 펄스 폭
+int ultrasonic_pulse_from_events(const struct gpiod_line_event *events,
+                                 int count, int64_t *pulse_ns)
+{
+  const struct timespec *rise = NULL;
+
+  for (int i = 0; i < count; i++)
+  {
+    if (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE)
+    {
+      if (rise == NULL)
+      {
+        rise = &events[i].ts;
+      }
+    }
+    else if (rise != NULL)
+    {
+      *pulse_ns = timespec_diff_ns(&events[i].ts, rise);
+      return US_OK;
+    }
+  }
+
+  return (rise == NULL) ? US_TIMEOUT_HIGH : US_TIMEOUT_LOW;
+}
+
+// ========== 트리거 펄스 (10us) ==========
+static void send_trigger(struct ultrasonic *us)
+{
+  gpiod_line_set_value(us->trig, 0);
+  usleep(2);
+  gpiod_line_set_value(us->trig, 1);
+  usleep(10);
+  gpiod_line_set_value(us->trig, 0);
+}
+
+// ========== 이전 측정에서 남은 이벤트 버리기 ==========
+// 마감 이후 늦게 도착한 하강 에지가 다음 측정에 섞이지 않도록 함
+void ultrasonic_drain(struct ultrasonic *us)
+{
+  struct gpiod_line_event stale[US_MAX_EVENTS];
+  struct timespec zero = { 0, 0 };
+
+  while (gpiod_line_event_wait(us->echo, &zero) > 0)
+  {
+    if (gpiod_line_event_read_multiple(us->echo, stale, US_MAX_EVENTS) <= 0)
+    {
+      break;
+    }
+  }
+}
+
+// ========== 에코 이벤트 fd ==========
+int ultrasonic_event_fd(struct ultrasonic *us)
+{
+  return us->use_events ? gpiod_line_event_get_fd(us->echo) : -1;
+}
+
+// ========== 비동기 측정 시작 ==========
+// 남은 이벤트를 비우고 트리거를 보낸 뒤 마감 시각(CLOCK_MONOTONIC ns)을 돌려줌
+int64_t ultrasonic_start(struct ultrasonic *us)
+{
+  ultrasonic_drain(us);
+  us->event_count = 0;
+  send_trigger(us);
+  us->trigger_ns = monotonic_ns();
+  return us->trigger_ns + us->deadline_ns;
+}
+
+// ========== 도착한 에코 이벤트 읽기 ==========
+// 펄스가 완성되면 US_OK, 아직이면 US_PENDING
+int ultrasonic_read_events(struct ultrasonic *us, int64_t *pulse_ns)
+{
+  int ret;
+
+  if (us->event_count >= US_MAX_EVENTS)
+  {
+    return ultrasonic_finish(us, pulse_ns);
+  }
+
+  ret = gpiod_line_event_read_multiple(us->echo, &us->events[us->event_count],
+                                       US_MAX_EVENTS - us->event_count);
+  if (ret < 0)
+  {
+    return (errno == EAGAIN) ? US_PENDING : US_IO_ERROR;
+  }
+  us->event_count += ret;
+
+  if (record_result(us, pulse_ns) == US_OK)
+  {
+    return US_OK;
+  }
+  return US_PENDING;
+}
+
+// ========== 마감 시각 도달 ==========
+// 모은 이벤트로 최종 결과(성공 또는 어느 쪽 타임아웃인지)를 정함
+int ultrasonic_finish(struct ultrasonic *us, int64_t *pulse_ns)
+{
+  return record_result(us, pulse_ns);
+}
+
+// ========== 모은 이벤트 해석 + 상승 에지 시각 기록 ==========
+static int record_result(struct ultrasonic *us, int64_t *pulse_ns)
+{
+  int status = ultrasonic_pulse_from_events(us->events, us->event_count, pulse_ns);
+
+  if (status != US_OK)
+  {
+    return status;
+  }
+
+  for (int i = 0; i < us->event_count; i++)
+  {
+    if (us->events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE)
+    {
+      us->rise_ns = us->events[i].ts.tv_sec * 1000000000LL + us->events[i].ts.tv_nsec;
+      break;
+    }
+  }
+  return US_OK;
+}
+
+// ========== 에지 이벤트 측정 (블로킹) ==========
+static int measure_events(struct ultrasonic *us, int64_t *pulse_ns)
+{
+  struct timespec remaining;
+  int64_t deadline_ns = ultrasonic_start(us);
+  int64_t left_ns;
+  int ret;
+
+  while (1)
+  {
+    left_ns = deadline_ns - monotonic_ns();
+    if (left_ns <= 0)
+    {
+      break;
+    }
+
+    remaining.tv_sec = left_ns / 1000000000LL;
+    remaining.tv_nsec = left_ns % 1000000000LL;
+
+    ret = gpiod_line_event_wait(us->echo, &remaining);
+    if (ret < 0)
+    {
+      return US_IO_ERROR;
+    }
+    if (ret == 0)
+    {
+      break;
+    }
+
+    ret = ultrasonic_read_events(us, pulse_ns);
+    if (ret != US_PENDING)
+    {
+      return ret;
+    }
+  }
+
+  return ultrasonic_finish(us, pulse_ns);
+}
+
+// ========== 폴링 측정 (이벤트 요청 실패 시) ==========
+// 마감 시간은 이벤트 모드와 같은 값을 CLOCK_MONOTONIC으로 확인
+// 입력으로만 요청된 라인은 이벤트 fd가 없어 gpiod_line_event_wait로 기다릴 수 없으므로
+// 읽기 사이마다 US_POLL_STEP_NS씩 잠 (코어 하나를 계속 돌리지 않는 대신 해상도가 그만큼 낮음)
+static int measure_poll(struct ultrasonic *us, int64_t *pulse_ns)
+{
+  const struct timespec step = { 0, US_POLL_STEP_NS };
+  int64_t rise_ns, fall_ns;
+  int value;
+
+  send_trigger(us);
+  us->trigger_ns = monotonic_ns();
+
+  do
+  {
+    value = gpiod_line_get_value(us->echo);
+    rise_ns = monotonic_ns();
+    if (value < 0)
+    {
+      return US_IO_ERROR;
+    }
+    if (rise_ns - us->trigger_ns > us->deadline_ns)
+    {
+      return US_TIMEOUT_HIGH;
+    }
+    if (value == 0)
+    {
+      clock_nanosleep(CLOCK_MONOTONIC, 0, &step, NULL);
+    }
+  } while (value == 0);
+
+  do
+  {
+    value = gpiod_line_get_value(us->echo);
+    fall_ns = monotonic_ns();
+    if (value < 0)
+    {
+      return US_IO_ERROR;
+    }
+    if (fall_ns - us->trigger_ns > us->deadline_ns)
+    {
+      return US_TIMEOUT_LOW;
+    }
+    if (value == 1)
+    {
+      clock_nanosleep(CLOCK_MONOTONIC, 0, &step, NULL);
+    }
+  } while (value == 1);
+
+  *pulse_ns = fall_ns - rise_ns;
+  us->rise_ns = rise_ns;
+  return US_OK;
+}
+
+// ========== 시간 차이 (a - b, ns) ==========
+static int64_t timespec_diff_ns(const struct timespec *a, const struct timespec *b)
+{
+  return (a->tv_sec - b->tv_sec) * 1000000000LL + (a->tv_nsec - b->tv_nsec);
+}
@@ -0,0 +1,75 @@
+/*
+파일명: ultrasonic.h
+작성일: 2026-10-16
+설명: HC-SR04 초음파 센서 측정 모듈
+      에코 라인을 양방향 에지 이벤트로 요청하고
+      커널 이벤트 타임스탬프로 펄스 폭을 계산
+ */
+
+#ifndef ULTRASONIC_H
+#define ULTRASONIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <gpiod.h>
+
+// ========== 측정 범위 상수 ==========
+#define US_MIN_RANGE_CM 2.0           // HC-SR04 최소 측정 거리
+#define US_MAX_RANGE_CM 400.0         // HC-SR04 최대 측정 거리
+#define US_SOUND_SPEED_CM_S 34300.0   // 에코 마감 계산용 음속 (cm/s, 거리는 sound_speed 표로 계산)
+
+// 트리거 후 에코 상승까지의 여유 시간 (40kHz 버스트 8주기 + 센서 지연)
+#define US_ECHO_RISE_MARGIN_NS 2000000LL
+
+// 한 번의 측정에서 모으는 최대 에지 이벤트 수
+#define US_MAX_EVENTS 8
+
+// 폴링 모드에서 에코 라인 읽기 사이 대기 (20us ≈ 3.4mm)
+#define US_POLL_STEP_NS 20000L
+
+// ========== 측정 결과 코드 ==========
+enum us_status
+{
+  US_OK = 0,
+  US_TIMEOUT_HIGH = -1,   // 에코 상승 에지가 오지 않음
+  US_TIMEOUT_LOW = -2,    // 에코 하강 에지가 오지 않음
+  US_IO_ERROR = -3,       // GPIO 읽기 실패
+  US_PENDING = 1          // 비동기 측정: 아직 에코가 끝나지 않음
+};
+
+// ========== 초음파 센서 상태 ==========
+struct ultrasonic
+{
+  struct gpiod_line *trig;   // 출력으로 요청된 트리거 라인
+  struct gpiod_line *echo;   // 에코 라인
+  bool use_events;           // true: 에지 이벤트 모드, false: 폴링 모드
+  int64_t deadline_ns;       // 트리거부터 에코 종료까지 허용 시간
+
+  // 진행 중인 측정 상태 (이벤트 모드)
+  struct gpiod_line_event events[US_MAX_EVENTS];
+  int event_count;
+  int64_t trigger_ns;        // 트리거 시각 (CLOCK_MONOTONIC)
+  int64_t rise_ns;           // 직전 성공 측정의 에코 상승 시각 (커널 타임스탬프)
+};
+
+int ultrasonic_init(struct ultrasonic *us, struct gpiod_line *trig,
+                    struct gpiod_line *echo);
+void ultrasonic_release(struct ultrasonic *us);
+int ultrasonic_measure(struct ultrasonic *us, int64_t *pulse_ns);
+
+// ========== 비동기 측정 (이벤트 루프용) ==========
+// start로 트리거를 보내고 마감 시각을 받은 뒤,
+// 에코 fd가 읽기 가능해지면 read_events, 마감 시각이 지나면 finish 호출
+int ultrasonic_event_fd(struct ultrasonic *us);
+int64_t ultrasonic_start(struct ultrasonic *us);
+int ultrasonic_read_events(struct ultrasonic *us, int64_t *pulse_ns);
+int ultrasonic_finish(struct ultrasonic *us, int64_t *pulse_ns);
+void ultrasonic_drain(struct ultrasonic *us);
+
+// 이벤트 배열에서 첫 상승~하강 에지 사이의 펄스 폭 계산 (하드웨어 없이 테스트 가능)
+int ultrasonic_pulse_from_events(const struct gpiod_line_event *events,
+                                 int count, int64_t *pulse_ns);
+int64_t ultrasonic_deadline_ns(double max_range_cm);
+
+#endif
@@ -0,0 +1,79 @@
+/*
+파일명: ultrasonic_check.c
+작성일: 2026-10-16
+설명: 에코 에지 이벤트 해석 검증 (make check)
+      ultrasonic_pulse_from_events에 만든 이벤트 배열을 넣어
+      정상, 상승 에지 없음, 하강 에지 없음, 이벤트 없음(타임아웃) 결과를 확인
+      GPIO 없이 실행 (라인을 열지 않음)
+ */
+
+#include <stdio.h>
+#include "ultrasonic.h"
+
+static int failures = 0;
+
+// ========== 이벤트 하나 만들기 (시각은 ns) ==========
+static struct gpiod_line_event edge(int type, int64_t ts_ns)
+{
+  struct gpiod_line_event ev;
+
+  ev.event_type = type;
+  ev.ts.tv_sec = ts_ns / 1000000000LL;
+  ev.ts.tv_nsec = ts_ns % 1000000000LL;
+  return ev;
+}
+
+// ========== 결과 비교 ==========
+static void expect(const char *name, const struct gpiod_line_event *events, int count,
+                   int want_status, int64_t want_pulse_ns)
+{
+  int64_t pulse_ns = -1;
+  int status = ultrasonic_pulse_from_events(events, count, &pulse_ns);
+  bool ok = (status == want_status) && (want_status != US_OK || pulse_ns == want_pulse_ns);
+
+  printf("%-28s 결과 %2d, 펄스 %lld ns  %s\n", name, status, (long long)pulse_ns,
+         ok ? "통과" : "실패");
+  if (!ok)
+  {
+    failures++;
+  }
+}
+
+int main(void)
+{
+  const int R = GPIOD_LINE_EVENT_RISING_EDGE;
+  const int F = GPIOD_LINE_EVENT_FALLING_EDGE;
+  // 1m 물체의 왕복 시간 (약 5.83ms), 상승 시각은 초 경계 직전
+  const int64_t rise = 41999800000LL;
+  const int64_t pulse = 5830904LL;
+
+  struct gpiod_line_event normal[] = { edge(R, rise), edge(F, rise + pulse) };
+  // 이전 측정에서 늦게 온 하강 에지는 상승 에지 전이므로 무시
+  struct gpiod_line_event stale_fall[] = { edge(F, rise - 1000), edge(R, rise), edge(F, rise + pulse) };
+  // 채터링으로 상승이 두 번 오면 첫 상승부터 잼
+  struct gpiod_line_event double_rise[] = { edge(R, rise), edge(R, rise + 500), edge(F, rise + pulse) };
+  struct gpiod_line_event no_rise[] = { edge(F, rise + pulse) };
+  struct gpiod_line_event no_fall[] = { edge(R, rise) };
+
+  expect("정상", normal, 2, US_OK, pulse);
+  expect("앞선 하강 에지 무시", stale_fall, 3, US_OK, pulse);
+  expect("상승 에지 두 번", double_rise, 3, US_OK, pulse);
+  expect("상승 에지 없음", no_rise, 1, US_TIMEOUT_HIGH, 0);
+  expect("하강 에지 없음", no_fall, 1, US_TIMEOUT_LOW, 0);
+  expect("이벤트 없음 (타임아웃)", NULL, 0, US_TIMEOUT_HIGH, 0);
+
+  // 400cm 왕복(약 23.3ms) + 상승 여유 2ms
+  if (ultrasonic_deadline_ns(US_MAX_RANGE_CM) != 25323615LL)
+  {
+    printf("마감 시간 %lld ns  실패\n", (long long)ultrasonic_deadline_ns(US_MAX_RANGE_CM));
+    failures++;
+  }
+
+  if (failures > 0)
+  {
+    printf("실패 %d건\n", failures);
+    return 1;
+  }
+  printf("통과\n");
+  return 0;
+}
@@ -0,0 +1,426 @@
+/*
+파일명: us_array.c
+작성일: 2026-10-16
+설명: HC-SR04 센서 배열 측정 스레드
+      센서 i는 그룹 i % groups에 속하고, 슬롯마다 한 그룹의 트리거를
+      gpiod_line_set_value_bulk 한 번으로 동시에 올림 (이웃 센서는 다른 슬롯)
+      슬롯 간격은 그 그룹에서 가장 늦은 에코로 정하므로(ping_scheduler와 같은 식)
+      센서를 늘려도 슬롯 수는 그룹 수만큼만 늘고 전체 핑 속도는 거의 비례해 늘어남
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include "ultrasonic.h"
+#include "ping_scheduler.h"
+#include "us_array.h"
+#include "event_loop.h"
+
+static void *array_thread(void *arg);
+static int64_t fire_slot(struct us_array *arr, int group);
+static void read_line_events(struct us_array *arr, struct gpiod_line *line, int *remaining);
+static void drain_group(struct us_array *arr, int group);
+static struct us_array_sensor *sensor_for_line(struct us_array *arr, struct gpiod_line *line);
+static int64_t event_ns(const struct gpiod_line_event *event);
+
+// ========== 핀 목록 해석 ==========
+// "트리거:에코,트리거:에코,..." (예: "27:17,5:6,13:19") → 센서 수, 잘못되면 -1
+int us_array_parse(const char *spec, unsigned int *trig_pins, unsigned int *echo_pins)
+{
+  int count = 0;
+  const char *p = spec;
+
+  while (*p != '\0')
+  {
+    char *end;
+
+    if (count >= US_ARRAY_MAX)
+    {
+      return -1;
+    }
+    trig_pins[count] = strtoul(p, &end, 10);
+    if (end == p || *end != ':')
+    {
+      return -1;
+    }
+    p = end + 1;
+    echo_pins[count] = strtoul(p, &end, 10);
+    if (end == p || (*end != ',' && *end != '\0'))
+    {
+      return -1;
+    }
+    count++;
+    p = (*end == ',') ? end + 1 : end;
+  }
+  return (count > 0) ? count : -1;
+}
+
+// ========== 라인 bulk 요청 ==========
+// 트리거는 출력(모두 0), 에코는 양방향 에지 이벤트로 각각 한 번에 요청
+int us_array_open(struct us_array *arr, struct gpiod_chip *chip,
+                  const unsigned int *trig_pins, const unsigned int *echo_pins,
+                  int count, int groups)
+{
+  int zeros[US_ARRAY_MAX] = { 0 };
+
+  if (groups < 1)
+  {
+    groups = 1;
+  }
+  if (groups > count)
+  {
+    groups = count;
+  }
+  arr->count = count;
+  arr->groups = groups;
+  arr->deadline_ns = ultrasonic_deadline_ns(US_MAX_RANGE_CM);
+  arr->slots = 0;
+  arr->overruns = 0;
+  arr->started_ns = 0;
+  arr->last_slot_ns = 0;
+
+  if (gpiod_chip_get_lines(chip, (unsigned int *)trig_pins, count, &arr->trig) < 0 ||
+      gpiod_chip_get_lines(chip, (unsigned int *)echo_pins, count, &arr->echo) < 0)
+  {
+    perror("Array lines not found");
+    return -1;
+  }
+  if (gpiod_line_request_bulk_output(&arr->trig, "us_array_trig", zeros) < 0)
+  {
+    perror("Array trigger bulk request failed");
+    return -1;
+  }
+  if (gpiod_line_request_bulk_both_edges_events(&arr->echo, "us_array_echo") < 0)
+  {
+    perror("Array echo bulk request failed");
+    gpiod_line_release_bulk(&arr->trig);
+    return -1;
+  }
+
+  for (int g = 0; g < groups; g++)
+  {
+    gpiod_line_bulk_init(&arr->group_echo[g]);
+  }
+  for (int i = 0; i < count; i++)
+  {
+    struct us_array_sensor *sensor = &arr->sensors[i];
+
+    sensor->echo = gpiod_line_bulk_get_line(&arr->echo, i);
+    sensor->trig_pin = trig_pins[i];
+    sensor->echo_pin = echo_pins[i];
+    sensor->pings = 0;
+    sensor->ok = 0;
+    gpiod_line_bulk_add(&arr->group_echo[i % groups], sensor->echo);
+  }
+  return 0;
+}
+
+// ========== 측정 스레드 시작 ==========
+int us_array_start(struct us_array *arr)
+{
+  pthread_attr_t attr;
+  int ret;
+
+  atomic_init(&arr->stop, false);
+  sample_ring_init(&arr->ring);
+  arr->done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (arr->done_fd < 0)
+  {
+    perror("eventfd");
+    return -1;
+  }
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, US_ARRAY_STACK_SIZE);
+  ret = pthread_create(&arr->thread, &attr, array_thread, arr);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+  {
+    errno = ret;
+    perror("pthread_create (us array)");
+    close(arr->done_fd);
+    return -1;
+  }
+  return 0;
+}
+
+// ========== 결과 알림 fd ==========
+int us_array_done_fd(struct us_array *arr)
+{
+  return arr->done_fd;
+}
+
+// ========== 결과 꺼내기 (메인 루프) ==========
+bool us_array_poll(struct us_array *arr, struct sample *out)
+{
+  uint64_t count;
+
+  if (read(arr->done_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+  {
+    perror("us array done read");
+  }
+  return sample_ring_pop(&arr->ring, out);
+}
+
+// ========== 스레드 종료 ==========
+// 슬롯 사이(최대 60ms + 에코 마감)에 종료 요청을 확인
+void us_array_stop(struct us_array *arr)
+{
+  atomic_store(&arr->stop, true);
+  pthread_join(arr->thread, NULL);
+  close(arr->done_fd);
+}
+
+// ========== 라인 해제 ==========
+void us_array_close(struct us_array *arr)
+{
+  gpiod_line_release_bulk(&arr->trig);
+  gpiod_line_release_bulk(&arr->echo);
+}
+
+// ========== 센서별 / 전체 핑 속도 출력 ==========
+void us_array_print_stats(const struct us_array *arr)
+{
+  double elapsed_s = (arr->last_slot_ns - arr->started_ns) / 1e9;
+  uint64_t pings = 0;
+
+  for (int i = 0; i < arr->count; i++)
+  {
+    const struct us_array_sensor *sensor = &arr->sensors[i];
+
+    printf("센서 %d (트리거 %u, 에코 %u, 그룹 %d): 핑 %llu회, 유효 %llu회\n",
+           i, sensor->trig_pin, sensor->echo_pin, i % arr->groups,
+           (unsigned long long)sensor->pings, (unsigned long long)sensor->ok);
+    pings += sensor->pings;
+  }
+
+  if (arr->slots < 2 || elapsed_s <= 0)
+  {
+    return;
+  }
+  // 첫 슬롯부터 마지막 슬롯 시작까지 (slots - 1)개 간격, 마지막 슬롯의 핑은 빼고 계산
+  printf("센서 배열: %d개, %d그룹, 슬롯 %.1f/s, 전체 %.1f pings/s, 슬롯 밀림 %llu회\n",
+         arr->count, arr->groups, (arr->slots - 1) / elapsed_s,
+         (pings - (double)pings / arr->slots) / elapsed_s,
+         (unsigned long long)arr->overruns);
+}
+
+// ========== 측정 스레드 본체 ==========
+// 슬롯 시각은 직전 예약 시각 + 간격이라 지연이 쌓이지 않음
+static void *array_thread(void *arg)
+{
+  struct us_array *arr = arg;
+  struct timespec at;
+  int64_t next_ns = monotonic_ns() + PING_MIN_INTERVAL_NS;
+  int group = 0;
+
+  arr->started_ns = next_ns;
+
+  while (!atomic_load(&arr->stop))
+  {
+    int64_t interval_ns;
+    uint64_t one = 1;
+
+    at.tv_sec = next_ns / 1000000000LL;
+    at.tv_nsec = next_ns % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) == EINTR)
+    {
+    }
+
+    interval_ns = fire_slot(arr, group);
+
+    // 그룹 센서들의 결과를 링에 넣고 한 번만 알림
+    for (int i = group; i < arr->count; i += arr->groups)
+    {
+      struct us_array_sensor *sensor = &arr->sensors[i];
+      struct sample s;
+
+      memset(&s, 0, sizeof(s));
+      s.scheduled_ns = next_ns;
+      s.trigger_ns = arr->last_slot_ns;
+      s.rise_ns = (sensor->status == US_OK) ? sensor->rise_ns : 0;
+      s.pulse_ns = sensor->pulse_ns;
+      s.spread_ns = -1;
+      s.status = sensor->status;
+      s.num = sensor->pings;
+      s.pings = (sensor->status == US_OK) ? 1 : 0;
+      s.sensor_id = i;
+      sample_ring_push(&arr->ring, &s);
+    }
+    if (write(arr->done_fd, &one, sizeof(one)) != sizeof(one))
+    {
+      perror("us array done write");
+    }
+
+    arr->slots++;
+    next_ns += interval_ns;
+    if (next_ns < monotonic_ns() + PING_RINGDOWN_NS)
+    {
+      next_ns = monotonic_ns() + PING_RINGDOWN_NS;
+      arr->overruns++;
+    }
+    group = (group + 1) % arr->groups;
+  }
+
+  return NULL;
+}
+
+// ========== 슬롯 1회: 그룹 트리거 → 에코 수집 ==========
+// 다음 슬롯까지의 간격(그룹에서 가장 긴 ping_interval_ns)을 돌려줌
+// 트리거 시각은 last_slot_ns에 남김
+static int64_t fire_slot(struct us_array *arr, int group)
+{
+  int values[US_ARRAY_MAX];
+  int remaining = 0;
+  int64_t trigger_ns, interval_ns = PING_MIN_INTERVAL_NS;
+
+  drain_group(arr, group);
+
+  for (int i = 0; i < arr->count; i++)
+  {
+    values[i] = (i % arr->groups == group);
+    if (values[i])
+    {
+      arr->sensors[i].rise_ns = 0;
+      arr->sensors[i].pulse_ns = 0;
+      arr->sensors[i].done = false;
+      remaining++;
+    }
+  }
+
+  // 그룹 트리거를 한꺼번에 10us 올림 (나머지는 0 유지)
+  gpiod_line_set_value_bulk(&arr->trig, values);
+  usleep(10);
+  memset(values, 0, sizeof(values));
+  gpiod_line_set_value_bulk(&arr->trig, values);
+  trigger_ns = monotonic_ns();
+  arr->last_slot_ns = trigger_ns;
+
+  // 그룹 에코 라인 전체를 한 번에 기다림
+  while (remaining > 0)
+  {
+    int64_t left_ns = trigger_ns + arr->deadline_ns - monotonic_ns();
+    struct gpiod_line_bulk ready;
+    struct timespec timeout;
+    int ret;
+
+    if (left_ns <= 0)
+    {
+      break;
+    }
+    timeout.tv_sec = left_ns / 1000000000LL;
+    timeout.tv_nsec = left_ns % 1000000000LL;
+
+    ret = gpiod_line_event_wait_bulk(&arr->group_echo[group], &timeout, &ready);
+    if (ret <= 0)
+    {
+      if (ret < 0)
+      {
+        perror("Array echo wait failed");
+      }
+      break;
+    }
+    for (unsigned int j = 0; j < gpiod_line_bulk_num_lines(&ready); j++)
+    {
+      read_line_events(arr, gpiod_line_bulk_get_line(&ready, j), &remaining);
+    }
+  }
+
+  for (int i = group; i < arr->count; i += arr->groups)
+  {
+    struct us_array_sensor *sensor = &arr->sensors[i];
+    int64_t sensor_interval_ns;
+
+    if (!sensor->done)
+    {
+      sensor->status = (sensor->rise_ns != 0) ? US_TIMEOUT_LOW : US_TIMEOUT_HIGH;
+    }
+    sensor->pings++;
+    if (sensor->status == US_OK)
+    {
+      sensor->ok++;
+    }
+
+    sensor_interval_ns = ping_interval_ns(sensor->status, sensor->pulse_ns);
+    if (sensor_interval_ns > interval_ns)
+    {
+      interval_ns = sensor_interval_ns;
+    }
+  }
+  return interval_ns;
+}
+
+// ========== 에코 라인 하나의 이벤트 처리 ==========
+// 첫 상승 에지 → 그 뒤 첫 하강 에지로 펄스 폭 (ultrasonic_pulse_from_events와 같은 규칙)
+static void read_line_events(struct us_array *arr, struct gpiod_line *line, int *remaining)
+{
+  struct us_array_sensor *sensor = sensor_for_line(arr, line);
+  struct gpiod_line_event events[US_ARRAY_EVENT_BATCH];
+  int count = gpiod_line_event_read_multiple(line, events, US_ARRAY_EVENT_BATCH);
+
+  if (sensor == NULL || count <= 0)
+  {
+    return;
+  }
+
+  for (int i = 0; i < count && !sensor->done; i++)
+  {
+    if (events[i].event_type == GPIOD_LINE_EVENT_RISING_EDGE)
+    {
+      if (sensor->rise_ns == 0)
+      {
+        sensor->rise_ns = event_ns(&events[i]);
+      }
+    }
+    else if (sensor->rise_ns != 0)
+    {
+      sensor->pulse_ns = event_ns(&events[i]) - sensor->rise_ns;
+      sensor->status = US_OK;
+      sensor->done = true;
+      (*remaining)--;
+    }
+  }
+}
+
+// ========== 이전 슬롯에서 늦게 온 에지 버리기 ==========
+static void drain_group(struct us_array *arr, int group)
+{
+  struct timespec zero = { 0, 0 };
+  struct gpiod_line_bulk ready;
+  struct gpiod_line_event stale[US_ARRAY_EVENT_BATCH];
+
+  while (gpiod_line_event_wait_bulk(&arr->group_echo[group], &zero, &ready) > 0)
+  {
+    for (unsigned int j = 0; j < gpiod_line_bulk_num_lines(&ready); j++)
+    {
+      if (gpiod_line_event_read_multiple(gpiod_line_bulk_get_line(&ready, j),
+                                         stale, US_ARRAY_EVENT_BATCH) <= 0)
+      {
+        return;
+      }
+    }
+  }
+}
+
+// ========== 이벤트가 온 라인 → 센서 ==========
+static struct us_array_sensor *sensor_for_line(struct us_array *arr, struct gpiod_line *line)
+{
+  for (int i = 0; i < arr->count; i++)
+  {
+    if (arr->sensors[i].echo == line)
+    {
+      return &arr->sensors[i];
+    }
+  }
+  return NULL;
+}
+
+// ========== 이벤트 타임스탬프 (ns) ==========
+static int64_t event_ns(const struct gpiod_line_event *event)
+{
+  return event->ts.tv_sec * 1000000000LL + event->ts.tv_nsec;
+}
@@ -0,0 +1,76 @@
+/*
+파일명: us_array.h
+작성일: 2026-10-16
+설명: HC-SR04 여러 개를 묶은 센서 배열 (-A 옵션)
+      트리거/에코 라인을 각각 bulk 요청 한 번으로 잡고,
+      서로 떨어진 센서끼리 같은 슬롯에 함께 쏘며 슬롯마다 그룹을 돌아가며 바꿈
+      슬롯의 에코는 모두 한 번의 bulk 대기로 받아 커널 타임스탬프로 잼
+ */
+
+#ifndef US_ARRAY_H
+#define US_ARRAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <gpiod.h>
+#include "sample_ring.h"
+
+#define US_ARRAY_MAX 8              // 최대 센서 수
+#define US_ARRAY_DEFAULT_GROUPS 2   // 기본 그룹 수 (이웃한 센서는 같은 슬롯에 안 쏨)
+#define US_ARRAY_EVENT_BATCH 8      // 라인 하나에서 한 번에 읽는 최대 이벤트 수
+#define US_ARRAY_STACK_SIZE (128 * 1024)  // 배열 측정 스레드 스택
+
+// ========== 센서 하나 ==========
+struct us_array_sensor
+{
+  struct gpiod_line *echo;   // bulk 안의 에코 라인 (이벤트 소속 판별용)
+  unsigned int trig_pin;
+  unsigned int echo_pin;
+  int64_t rise_ns;           // 이번 슬롯의 에코 상승 시각 (0이면 아직)
+  int64_t pulse_ns;
+  int status;
+  bool done;                 // 이번 슬롯에서 하강 에지까지 받음
+
+  // 통계
+  uint64_t pings;
+  uint64_t ok;
+};
+
+// ========== 센서 배열 ==========
+struct us_array
+{
+  int count;
+  int groups;                          // 슬롯 그룹 수 (센서 i는 그룹 i % groups)
+  struct gpiod_line_bulk trig;         // 모든 트리거 라인 (출력 bulk 요청)
+  struct gpiod_line_bulk echo;         // 모든 에코 라인 (양방향 에지 bulk 요청)
+  struct gpiod_line_bulk group_echo[US_ARRAY_MAX];  // 그룹별 에코 라인 (대기용)
+  struct us_array_sensor sensors[US_ARRAY_MAX];
+  int64_t deadline_ns;                 // 트리거부터 에코 종료까지 허용 시간
+
+  // 측정 스레드
+  pthread_t thread;
+  _Atomic bool stop;
+  int done_fd;                         // eventfd: 슬롯 결과 있음 (메인 루프 epoll 등록)
+  struct sample_ring ring;             // 센서별 측정 결과 (sensor_id 포함)
+
+  // 통계 (스레드만 씀, 종료 후 읽기)
+  uint64_t slots;
+  uint64_t overruns;                   // 에코 대기가 길어 다음 슬롯을 뒤로 민 횟수
+  int64_t started_ns;
+  int64_t last_slot_ns;
+};
+
+int us_array_parse(const char *spec, unsigned int *trig_pins, unsigned int *echo_pins);
+int us_array_open(struct us_array *arr, struct gpiod_chip *chip,
+                  const unsigned int *trig_pins, const unsigned int *echo_pins,
+                  int count, int groups);
+int us_array_start(struct us_array *arr);
+int us_array_done_fd(struct us_array *arr);
+bool us_array_poll(struct us_array *arr, struct sample *out);
+void us_array_stop(struct us_array *arr);
+void us_array_close(struct us_array *arr);
+void us_array_print_stats(const struct us_array *arr);
+
+#endif
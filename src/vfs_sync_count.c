@@ -0,0 +1,172 @@
+/*
+파일명: vfs_sync_count.c
+작성일: 2026-10-16
+설명: fsync 횟수를 세는 SQLite VFS 껍데기
+      sqlite3_open_v2(..., VFS_SYNC_COUNT_NAME)으로 연 DB의 xSync 호출 수를 셈
+      (WAL, 저널, DB 파일 모두 포함 → 실제 fsync 횟수와 같음)
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include <sqlite3.h>
+#include "vfs_sync_count.h"
+
+// ========== 파일 래퍼 ==========
+// 실제 VFS 파일 구조체가 바로 뒤에 붙음
+struct count_file
+{
+  sqlite3_file base;
+  sqlite3_file *real;
+};
+
+static sqlite3_vfs count_vfs;
+static sqlite3_vfs *real_vfs = NULL;
+static _Atomic uint64_t sync_count = 0;
+
+#define REAL(f) (((struct count_file *)(f))->real)
+
+// ========== 파일 메서드 (모두 실제 파일로 위임) ==========
+static int cf_close(sqlite3_file *f)
+{
+  return REAL(f)->pMethods->xClose(REAL(f));
+}
+
+static int cf_read(sqlite3_file *f, void *buf, int amt, sqlite3_int64 ofs)
+{
+  return REAL(f)->pMethods->xRead(REAL(f), buf, amt, ofs);
+}
+
+static int cf_write(sqlite3_file *f, const void *buf, int amt, sqlite3_int64 ofs)
+{
+  return REAL(f)->pMethods->xWrite(REAL(f), buf, amt, ofs);
+}
+
+static int cf_truncate(sqlite3_file *f, sqlite3_int64 size)
+{
+  return REAL(f)->pMethods->xTruncate(REAL(f), size);
+}
+
+static int cf_sync(sqlite3_file *f, int flags)
+{
+  atomic_fetch_add_explicit(&sync_count, 1, memory_order_relaxed);
+  return REAL(f)->pMethods->xSync(REAL(f), flags);
+}
+
+static int cf_file_size(sqlite3_file *f, sqlite3_int64 *size)
+{
+  return REAL(f)->pMethods->xFileSize(REAL(f), size);
+}
+
+static int cf_lock(sqlite3_file *f, int lock)
+{
+  return REAL(f)->pMethods->xLock(REAL(f), lock);
+}
+
+static int cf_unlock(sqlite3_file *f, int lock)
+{
+  return REAL(f)->pMethods->xUnlock(REAL(f), lock);
+}
+
+static int cf_check_reserved_lock(sqlite3_file *f, int *out)
+{
+  return REAL(f)->pMethods->xCheckReservedLock(REAL(f), out);
+}
+
+static int cf_file_control(sqlite3_file *f, int op, void *arg)
+{
+  return REAL(f)->pMethods->xFileControl(REAL(f), op, arg);
+}
+
+static int cf_sector_size(sqlite3_file *f)
+{
+  return REAL(f)->pMethods->xSectorSize(REAL(f));
+}
+
+static int cf_device_characteristics(sqlite3_file *f)
+{
+  return REAL(f)->pMethods->xDeviceCharacteristics(REAL(f));
+}
+
+static int cf_shm_map(sqlite3_file *f, int page, int size, int extend, void volatile **pp)
+{
+  return REAL(f)->pMethods->xShmMap(REAL(f), page, size, extend, pp);
+}
+
+static int cf_shm_lock(sqlite3_file *f, int offset, int n, int flags)
+{
+  return REAL(f)->pMethods->xShmLock(REAL(f), offset, n, flags);
+}
+
+static void cf_shm_barrier(sqlite3_file *f)
+{
+  REAL(f)->pMethods->xShmBarrier(REAL(f));
+}
+
+static int cf_shm_unmap(sqlite3_file *f, int delete_flag)
+{
+  return REAL(f)->pMethods->xShmUnmap(REAL(f), delete_flag);
+}
+
+static int cf_fetch(sqlite3_file *f, sqlite3_int64 ofs, int amt, void **pp)
+{
+  return REAL(f)->pMethods->xFetch(REAL(f), ofs, amt, pp);
+}
+
+static int cf_unfetch(sqlite3_file *f, sqlite3_int64 ofs, void *p)
+{
+  return REAL(f)->pMethods->xUnfetch(REAL(f), ofs, p);
+}
+
+static const sqlite3_io_methods count_io_methods =
+{
+  3,
+  cf_close, cf_read, cf_write, cf_truncate, cf_sync, cf_file_size,
+  cf_lock, cf_unlock, cf_check_reserved_lock, cf_file_control,
+  cf_sector_size, cf_device_characteristics,
+  cf_shm_map, cf_shm_lock, cf_shm_barrier, cf_shm_unmap,
+  cf_fetch, cf_unfetch
+};
+
+// ========== VFS 메서드 ==========
+// xOpen만 감싸고 나머지는 실제 VFS 함수를 그대로 씀
+static int cv_open(sqlite3_vfs *vfs, const char *name, sqlite3_file *f,
+                   int flags, int *out_flags)
+{
+  struct count_file *cf = (struct count_file *)f;
+  int rc;
+  (void)vfs;
+
+  cf->real = (sqlite3_file *)&cf[1];
+  rc = real_vfs->xOpen(real_vfs, name, cf->real, flags, out_flags);
+  // 실제 파일이 열리지 않았으면 pMethods를 비워 둬야 SQLite가 xClose를 부르지 않음
+  cf->base.pMethods = (cf->real->pMethods != NULL) ? &count_io_methods : NULL;
+  return rc;
+}
+
+// ========== 등록 ==========
+int vfs_sync_count_register(void)
+{
+  if (real_vfs != NULL)
+  {
+    return SQLITE_OK;
+  }
+
+  real_vfs = sqlite3_vfs_find(NULL);
+  if (real_vfs == NULL)
+  {
+    return SQLITE_ERROR;
+  }
+
+  count_vfs = *real_vfs;
+  count_vfs.zName = VFS_SYNC_COUNT_NAME;
+  count_vfs.szOsFile = (int)sizeof(struct count_file) + real_vfs->szOsFile;
+  count_vfs.xOpen = cv_open;
+  count_vfs.pNext = NULL;
+  return sqlite3_vfs_register(&count_vfs, 0);
+}
+
+// ========== 지금까지의 fsync 횟수 ==========
+uint64_t vfs_sync_count_get(void)
+{
+  return atomic_load_explicit(&sync_count, memory_order_relaxed);
+}
@@ -0,0 +1,18 @@
+/*
+파일명: vfs_sync_count.h
+작성일: 2026-10-16
+설명: fsync 횟수를 세는 SQLite VFS 껍데기
+      기본 VFS에 모든 호출을 그대로 넘기고 xSync 호출 수만 센다
+ */
+
+#ifndef VFS_SYNC_COUNT_H
+#define VFS_SYNC_COUNT_H
+
+#include <stdint.h>
+
+#define VFS_SYNC_COUNT_NAME "synccount"
+
+int vfs_sync_count_register(void);
+uint64_t vfs_sync_count_get(void);
+
+#endif